@@ -5,6 +5,8 @@
  * 
  * Programme permettant de lire des mots dans un fichier texte passé
  * en paramètre et qui calcule leurs fréquence.
+ * Un second paramètre optionnel donne le nombre de threads utilisés
+ * pour compter les mots (par défaut, le nombre de coeurs).
  *
  * @section copyright Copyright
  *
@@ -33,6 +35,9 @@
 */
 #include <functional>
 #include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <vector>
 #include <fstream> // Permet de lire et enregistrer des données dans un fichier
 //#include "dictionnaire_hash.hpp" //dictionnaire utilisant la hashtable
 #include "dictionnaire_arbre.hpp"  //dictionnaire utilisant l'arbre
@@ -43,30 +48,26 @@ using namespace std;
  
  int main(int argc,const char** argv){
 
-	if(2 != argc){
+	if(2 != argc and 3 != argc){
 		perror("Bad arguments!");
 		exit(1);
 	}
+	unsigned nbThreads = 3 == argc ? atoi(argv[2]) : thread::hardware_concurrency();
 
 	Dictionnaire dico = Dictionnaire();	
 	
 	fstream file;
 	string word;
 	file.open(argv[1], ios::in);
-	int j=0;
+	vector<string> mots;
 	cout<<"Fichier ouvert, début de la lecture"<<endl;
-	while(not file.eof()){
-		file >> word;
-		if(dico.contientMot(word)){
-			dico.associerMot(word);
-		}
-		else{
-			dico.ajouterMot(word);
-		}
-		++j;
+	while(file >> word){
+		mots.push_back(word);
 	}
 	file.close();
-	cout<<"Lecture terminée, "<<j<<" mots ont été ajouté"<<endl;
+	// les mots sont comptés par plusieurs threads si le dictionnaire le permet
+	dico.incrementerMots(mots, nbThreads);
+	cout<<"Lecture terminée, "<<mots.size()<<" mots ont été ajouté"<<endl;
 
 	pair<string,int> freq[10];
 
@@ -75,5 +76,12 @@ using namespace std;
 	for(int i=0;i<10;++i){
 		cout<<freq[i].first<<" : "<<freq[i].second<<endl;
 	}
+#ifdef HASHTABLE_STATS
+	// statistiques de la table, ou de l'arbre
+	cout<<"Statistiques du dictionnaire : "<<endl<<dico.statistiques().toString();
+#endif
+#ifdef DICOFILTRE
+	cout<<"Statistiques du filtre de Bloom : "<<endl<<dico.statistiquesFiltre().toString();
+#endif
 	return 0;
 }
@@ -0,0 +1,263 @@
+/**
+ * @file bloomfilter.hpp
+ *
+ * @section desc File description
+ *
+ * probabilistic set telling if a key may have been added, or surely not,
+ * used in front of a container to reject most missing keys at once
+ *
+ * Keys are hashed by a hasher H, as for Hashtable (see hashers.hpp).
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+/// macro to define the default false positive rate of bloom filters
+#ifndef BLOOMRATE
+#define BLOOMRATE 0.01
+#endif
+
+// included files section
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "hashers.hpp"
+#include "hashtable.hpp"
+
+/** \brief What a bloom filter holds and how many queries it rejected.
+*/
+struct BloomStats {
+	unsigned blocks; /** number of 512 bits blocks */
+	unsigned hashes; /** number of bits set for each key */
+	unsigned long keys; /** keys added which were not in the filter yet */
+	unsigned long bitsSet; /** number of bits set */
+	double fillRatio; /** bits set divided by the number of bits */
+	double falsePositiveRate; /** estimated chance that a missing key is not rejected */
+	unsigned long queries; /** calls to mayContain, counted only if HASHTABLE_STATS is defined */
+	unsigned long rejections; /** calls to mayContain which returned false, counted only if HASHTABLE_STATS is defined */
+
+	/** Return a description of the statistics, one per line
+	 * @param[out] desc a string representation of the statistics
+	*/
+	std::string toString() const {
+		return "blocks: " + std::to_string(blocks)
+			+ "\nhashes: " + std::to_string(hashes)
+			+ "\nkeys: " + std::to_string(keys)
+			+ "\nfill ratio: " + std::to_string(fillRatio)
+			+ "\nfalse positive rate: " + std::to_string(falsePositiveRate)
+#ifdef HASHTABLE_STATS
+			+ "\nqueries: " + std::to_string(queries)
+			+ "\nrejections: " + std::to_string(rejections)
+#endif
+			+ "\n";
+	}
+};
+
+/** \brief Blocked bloom filter : tells if a key may have been added.
+ *
+ * A key only sets bits into one block of 512 bits, the size of a cache
+ * line, so a query reads a single cache line whatever the number of hashes.
+ * Blocks are chosen with the high bits of the hashcode, bits into the block
+ * with a second hashcode mixed from the first one.
+ * Keys cannot be removed. Bits are set atomically, so several threads can
+ * add and query keys at once. A query writes nothing, unless HASHTABLE_STATS
+ * is defined : queries and rejections are then counted.
+*/
+template <typename K, typename H = DefaultHasher<K>>
+class BloomFilter {
+
+	private:
+		/** \brief 512 bits, alone on their cache line */
+		struct alignas(64) Block {
+			std::atomic<uint64_t> words[8]; /** bits of the block */
+		};
+
+		std::unique_ptr<Block[]> _blocks; /** array of blocks */
+		unsigned _blockCount; /** number of blocks, a power of two */
+		unsigned _hashes; /** number of bits set for each key */
+		H _hasher; /** computes hashcodes of keys */
+		std::atomic<unsigned long> _keys; /** keys added which were not in the filter yet */
+		std::atomic<unsigned long> _queries; /** calls to mayContain */
+		std::atomic<unsigned long> _rejections; /** calls to mayContain which returned false */
+
+		/** Block of a hashcode
+		 * @param[in] hash hashcode of a key
+		 * @param[out] block the block where the bits of the key are
+		*/
+		Block& blockOf(size_t hash) const {
+			return _blocks[(hash >> 32) & (_blockCount-1)];
+		}
+
+		/** Compute the bits of a key into its block
+		 * @param[in] hash hashcode of the key
+		 * @param[in] masks set to the bits of each word of the block
+		*/
+		void masksOf(size_t hash, uint64_t* masks) const {
+			for(unsigned w = 0; w<8; ++w) masks[w] = 0;
+			uint64_t mixed = mixHash(hash);
+			uint32_t h1 = (uint32_t)mixed;
+			uint32_t h2 = (uint32_t)(mixed >> 32) | 1;
+			for(unsigned i = 0; i<_hashes; ++i){
+				// 9 high bits choose one of the 512 bits of the block
+				unsigned bit = (h1 + i*h2) >> 23;
+				masks[bit >> 6] |= (uint64_t)1 << (bit & 63);
+			}
+		}
+
+	public:
+		/** Constructor, the filter is sized for a number of keys
+		 * @param[in] expectedKeys number of keys the filter is made for
+		 * @param[in] falsePositiveRate chance that a missing key is not rejected once expectedKeys keys are added
+		 * @param[in] hasher hash function of the filter
+		 * @exception HashtableException threw if falsePositiveRate is not between 0 and 1
+		*/
+		explicit BloomFilter(size_t expectedKeys, double falsePositiveRate = BLOOMRATE, const H &hasher = H()):
+		_hasher(hasher),
+		_keys(0),
+		_queries(0),
+		_rejections(0)
+		{
+			if(not(0 < falsePositiveRate and falsePositiveRate < 1)){
+				throw HashtableException("False positive rate must be between 0 and 1!");
+			}
+			if(0 == expectedKeys) expectedKeys = 1;
+			const double ln2 = std::log(2.0);
+			// optimal number of bits and hashes of a classic bloom filter
+			double bits = -(double)expectedKeys*std::log(falsePositiveRate)/(ln2*ln2);
+			long hashes = std::lround(bits/expectedKeys*ln2);
+			_hashes = hashes < 1 ? 1 : (16 < hashes ? 16 : (unsigned)hashes);
+			_blockCount = 1;
+			while(_blockCount*512.0 < bits) _blockCount *= 2;
+			_blocks.reset(new Block[_blockCount]);
+			clear();
+		}
+
+		/// bits are atomic, the filter cannot be copied
+		BloomFilter(const BloomFilter<K,H> &other) = delete;
+
+		/// bits are atomic, the filter cannot be copied
+		BloomFilter<K,H>& operator=(const BloomFilter<K,H> &other) = delete;
+
+		/** Remove every key and reset the counters
+		*/
+		void clear(){
+			for(unsigned b = 0; b<_blockCount; ++b){
+				for(unsigned w = 0; w<8; ++w){
+					_blocks[b].words[w].store(0, std::memory_order_relaxed);
+				}
+			}
+			_keys.store(0, std::memory_order_relaxed);
+			_queries.store(0, std::memory_order_relaxed);
+			_rejections.store(0, std::memory_order_relaxed);
+		}
+
+		/** Add a key to the filter
+		 * Words already holding the bits of the key are not written.
+		 * @param[in] key a K or any type the hasher accepts
+		*/
+		template <typename Q>
+		void add(const Q &key){
+			size_t hash = _hasher(key);
+			uint64_t masks[8];
+			masksOf(hash, masks);
+			Block &block = blockOf(hash);
+			bool added = false;
+			for(unsigned w = 0; w<8; ++w){
+				if(masks[w] != (block.words[w].load(std::memory_order_relaxed) & masks[w])){
+					block.words[w].fetch_or(masks[w], std::memory_order_relaxed);
+					added = true;
+				}
+			}
+			if(added) _keys.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/** May the key have been added ?
+		 * @param[in] key a K or any type the hasher accepts
+		 * @param[out] bool false if the key was surely not added, true if it may have been
+		*/
+		template <typename Q>
+		bool mayContain(const Q &key){
+			size_t hash = _hasher(key);
+			uint64_t masks[8];
+			masksOf(hash, masks);
+			const Block &block = blockOf(hash);
+#ifdef HASHTABLE_STATS
+			_queries.fetch_add(1, std::memory_order_relaxed);
+#endif
+			for(unsigned w = 0; w<8; ++w){
+				if(masks[w] != (block.words[w].load(std::memory_order_relaxed) & masks[w])){
+#ifdef HASHTABLE_STATS
+					_rejections.fetch_add(1, std::memory_order_relaxed);
+#endif
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/** Number of blocks of the filter
+		 * @param[out] count number of 512 bits blocks
+		*/
+		unsigned blockCount(){ return _blockCount; }
+
+		/** Number of bits set for each key
+		 * @param[out] hashes number of bits
+		*/
+		unsigned hashCount(){ return _hashes; }
+
+		/** What the filter holds and how many queries it rejected
+		 * Bits are counted while other threads may add keys.
+		 * @param[out] stats statistics of the filter
+		*/
+		BloomStats stats() const {
+			BloomStats stats;
+			stats.blocks = _blockCount;
+			stats.hashes = _hashes;
+			stats.keys = _keys.load(std::memory_order_relaxed);
+			stats.bitsSet = 0;
+			stats.falsePositiveRate = 0;
+			for(unsigned b = 0; b<_blockCount; ++b){
+				unsigned bits = 0;
+				for(unsigned w = 0; w<8; ++w){
+					bits += __builtin_popcountll(_blocks[b].words[w].load(std::memory_order_relaxed));
+				}
+				stats.bitsSet += bits;
+				// a missing key falling into this block passes if all its bits are set
+				stats.falsePositiveRate += std::pow(bits/512.0, (double)_hashes);
+			}
+			stats.fillRatio = (double)stats.bitsSet/(512.0*_blockCount);
+			stats.falsePositiveRate /= _blockCount;
+			stats.queries = _queries.load(std::memory_order_relaxed);
+			stats.rejections = _rejections.load(std::memory_order_relaxed);
+			return stats;
+		}
+};
+
+#endif // BLOOMFILTER_HPP
@@ -0,0 +1,79 @@
+/**
+ * @file classement.hpp
+ *
+ * @section desc File description
+ *
+ * Classement des mots les plus fréquents, commun aux dictionnaires
+ * 
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+ */
+
+#ifndef CLASSEMENT_HPP
+#define CLASSEMENT_HPP
+
+#include <string>
+#include <utility>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+using std::pair;
+
+/**
+ * Fonction de comparaison de deux pairs en utilisant la relation d'ordre
+ * sur les entiers appliqué à l'entier de la pair.
+ * @param[in] first la première pair à comparer
+ * @param[in] second la seconde pair à comparer
+ * @param[out] bool vrai si first>seconde sinon faux
+ */
+inline bool triPair(const pair<string, int> &first, const pair<string, int> &second){
+	return first.second > second.second;
+}
+
+/**
+ * Fonction qui place un mot dans le tableau des dix mots les plus fréquents,
+ * s'il est plus fréquent que le dernier. Le tableau reste trié par
+ * fréquences décroissantes, avec triPair.
+ * @param[in] frequences tableau des paires<mots,occurences> les plus fréquents
+ * @param[in] nb nombre de paires déjà dans le tableau, mis à jour
+ * @param[in] mot le mot à classer
+ * @param[in] occurences nombre d'occurences du mot
+ */
+inline void classerMot(pair<string,int> *frequences, int &nb, string_view mot, int occurences){
+	// seul le nombre d'occurences est comparé, le mot n'est copié que s'il est classé
+	pair<string,int> candidat(string(), occurences);
+	if(nb<10 or triPair(candidat, frequences[nb-1])){
+		int i = nb<10 ? nb++ : 9;
+		while(0<i and triPair(candidat, frequences[i-1])){
+			frequences[i] = frequences[i-1];
+			--i;
+		}
+		frequences[i] = pair<string,int>(string(mot), occurences);
+	}
+}
+
+#endif // CLASSEMENT_HPP
@@ -0,0 +1,366 @@
+/**
+ * @file concurrenthashtable.hpp
+ *
+ * @section desc File description
+ *
+ * hashtable which can be used by several threads at once
+ * keys are spread over shards, each shard is a Hashtable with its own lock
+ *
+ * the hash function is a template parameter, see hashers.hpp
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef CONCURRENTHASHTABLE_HPP
+#define CONCURRENTHASHTABLE_HPP
+
+/// macro to define the default number of shards
+#ifndef SHARDCOUNT
+#define SHARDCOUNT 64
+#endif
+
+/// macro to define the number of keys a batch groups by shard at once
+#ifndef SHARDBATCH
+#define SHARDBATCH 256
+#endif
+
+// included files section
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include "hashtable.hpp"
+
+/** \brief Maps a key to a value, usable by several threads at once.
+ *
+ * Keys are spread over shards by their hashcode. Each shard is a Hashtable,
+ * with its own buckets and allocator, locked by its own mutex: threads only
+ * wait for each other when they use keys of the same shard.
+ * Values are returned by copy, since a reference could be updated by another
+ * thread once the shard is unlocked.
+*/
+template <typename K, typename V, typename H = DefaultHasher<K>, typename A = SlabAllocator<Alveole<K,V>>>
+class ConcurrentHashtable {
+
+	private:
+		/** \brief A Hashtable and its lock, alone on its cache lines */
+		struct alignas(64) Shard {
+			std::mutex lock; /** lock of the table */
+			Hashtable<K,V,H,A> table; /** pairs of the shard */
+		};
+
+		std::unique_ptr<Shard[]> _shards; /** array of shards */
+		unsigned _shardCount; /** number of shards */
+		H _hasher; /** computes hashcodes of keys, as the tables of the shards */
+
+		/** Shard of a key
+		 * Buckets are chosen with the low bits of hashcodes, so shards
+		 * are chosen with the high ones.
+		 * @param[in] key a key
+		 * @param[out] shard the shard where key is stored
+		*/
+		template <typename Q>
+		Shard& shardOf(const Q &key){
+			return _shards[(_hasher(key) >> 32) % _shardCount];
+		}
+
+		/** Sort the keys of a chunk by shard, each key hashed once
+		 * A counting sort, so the keys of a shard keep their order : the
+		 * last value put to a key wins.
+		 * @param[in] keys keys of the chunk
+		 * @param[in] count number of keys, at most SHARDBATCH
+		 * @param[in] indexes set to the indexes of the keys, by shard then by index
+		 * @param[in] hashes set to the hashcodes, hashes[i] is the one of keys[indexes[i]]
+		 * @param[in] starts array of _shardCount+1 counters, set to the
+		 * position in indexes of the first key of each shard, and of the end
+		*/
+		template <typename Q>
+		void groupByShard(const Q* keys, size_t count, uint32_t* indexes, size_t* hashes, uint32_t* starts){
+			size_t keyHashes[SHARDBATCH];
+			uint32_t keyShards[SHARDBATCH];
+			std::fill(starts, starts + _shardCount + 1, 0);
+			for(size_t i = 0; i<count; ++i){
+				keyHashes[i] = _hasher(keys[i]);
+				keyShards[i] = (uint32_t)((keyHashes[i] >> 32) % _shardCount);
+				++starts[keyShards[i] + 1];
+			}
+			for(unsigned s = 0; s<_shardCount; ++s){
+				starts[s+1] += starts[s];
+			}
+			// starts[s] is used as the next place of shard s, then shifted back
+			for(size_t i = 0; i<count; ++i){
+				uint32_t place = starts[keyShards[i]]++;
+				indexes[place] = (uint32_t)i;
+				hashes[place] = keyHashes[i];
+			}
+			for(unsigned s = _shardCount; 0 < s; --s){
+				starts[s] = starts[s-1];
+			}
+			starts[0] = 0;
+		}
+
+		/** Call a function on the keys of each shard, the shard locked
+		 * Keys are grouped by shard SHARDBATCH at a time, so a shard is
+		 * locked once for all its keys of a chunk, and its Hashtable
+		 * prefetches their buckets together.
+		 * @param[in] keys array of keys
+		 * @param[in] count number of keys
+		 * @param[in] visit function called with the table of the shard, the
+		 * keys of the chunk and the index of its first key, then the indexes,
+		 * hashcodes and number of the keys of the shard in the chunk
+		*/
+		template <typename Q, typename F>
+		void forEachShard(const Q* keys, size_t count, F visit){
+			uint32_t indexes[SHARDBATCH];
+			size_t hashes[SHARDBATCH];
+			std::unique_ptr<uint32_t[]> starts(new uint32_t[_shardCount + 1]);
+			for(size_t start = 0; start<count; start += SHARDBATCH){
+				size_t n = count - start < SHARDBATCH ? count - start : SHARDBATCH;
+				groupByShard(keys + start, n, indexes, hashes, starts.get());
+				for(unsigned s = 0; s<_shardCount; ++s){
+					if(starts[s] == starts[s+1]) continue;
+					std::lock_guard<std::mutex> guard(_shards[s].lock);
+					visit(_shards[s].table, keys + start, start, indexes + starts[s], hashes + starts[s], starts[s+1] - starts[s]);
+				}
+			}
+		}
+
+	public:
+		/// type of the keys
+		typedef K key_type;
+		/// type of the values
+		typedef V mapped_type;
+
+		/** Simple constructor
+		 * @param[in] shardCount number of shards
+		 * @param[in] hasher hash function of the table, e.g. a seeded WyHasher
+		*/
+		explicit ConcurrentHashtable(unsigned shardCount = SHARDCOUNT, const H &hasher = H()):
+		_shards(new Shard[0 < shardCount ? shardCount : 1]),
+		_shardCount(0 < shardCount ? shardCount : 1),
+		_hasher(hasher)
+		{
+			for(unsigned i = 0; i<_shardCount; ++i){
+				_shards[i].table = Hashtable<K,V,H,A>(ARRAYSIZE, MAXLOADFACTOR, hasher);
+			}
+		}
+
+		/// shards hold mutexes, they cannot be copied
+		ConcurrentHashtable(const ConcurrentHashtable<K,V,H,A> &other) = delete;
+
+		/// shards hold mutexes, they cannot be copied
+		ConcurrentHashtable<K,V,H,A>& operator=(const ConcurrentHashtable<K,V,H,A> &other) = delete;
+
+		/** Do table contains key ?
+		 * @param[in] key key to find, a K or any type Hashtable looks up
+		 * @param[out] bool True if the key is here, else false
+		*/
+		template <typename Q>
+		bool contains(const Q &key){
+			Shard &shard = shardOf(key);
+			std::lock_guard<std::mutex> guard(shard.lock);
+			return shard.table.contains(key);
+		}
+
+		/** Return the value maped to the specified key
+		 * @param[in] key a key in the hashtable
+		 * @param[out] value copy of the value associated with the key
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		template <typename Q>
+		V get(const Q &key){
+			Shard &shard = shardOf(key);
+			std::lock_guard<std::mutex> guard(shard.lock);
+			return shard.table.get(key);
+		}
+
+		/** Tests if this hashtable maps no keys to values.
+		 * @param[out] bool true if no elements in the hashtable, else false;
+		*/
+		bool isEmpty(){
+			return 0 == size();
+		}
+
+		/** Number of pairs stored in the hashtable
+		 * Shards are counted one after the other, other threads may
+		 * change them meanwhile.
+		 * @param[out] size number of keys
+		*/
+		unsigned size(){
+			unsigned size = 0;
+			for(unsigned i = 0; i<_shardCount; ++i){
+				std::lock_guard<std::mutex> guard(_shards[i].lock);
+				size += _shards[i].table.size();
+			}
+			return size;
+		}
+
+		/** Number of shards
+		 * @param[out] count number of independently locked shards
+		*/
+		unsigned shardCount(){ return _shardCount; }
+
+		/** How the pairs are spread over the buckets of every shard, and the
+		 * counters of the shards added if HASHTABLE_STATS is defined
+		 * Shards are locked one after the other.
+		 * @param[out] stats statistics of the shards, as if they were one table
+		*/
+		TableStats stats(){
+			TableStats stats;
+			for(unsigned i = 0; i<_shardCount; ++i){
+				std::lock_guard<std::mutex> guard(_shards[i].lock);
+				stats.merge(_shards[i].table.stats());
+			}
+			return stats;
+		}
+
+		/** Map the specified key to the specified value in this hashtable.
+		 * or update the maped value to the key
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair
+		*/
+		template <typename Q>
+		void put(const Q &key, const V &value){
+			Shard &shard = shardOf(key);
+			std::lock_guard<std::mutex> guard(shard.lock);
+			shard.table.put(key, value);
+		}
+
+		/** Update the value maped to a key with a function, or map the key
+		 * to value if the key is not in the table. The shard stays locked
+		 * during the update, so concurrent updates of a key are not lost.
+		 * @param[in] key key of the pair
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[in] update function called with a reference to the value maped to key, if key was here
+		 * @param[out] value copy of the value maped to key after the update
+		*/
+		template <typename Q, typename F>
+		V upsert(const Q &key, const V &value, F update){
+			Shard &shard = shardOf(key);
+			std::lock_guard<std::mutex> guard(shard.lock);
+			return shard.table.upsert(key, value, update);
+		}
+
+		/** Map keys to values, as put does for each pair
+		 * Keys are grouped by shard, each shard is locked once for its
+		 * keys of a chunk, other threads can use the table meanwhile.
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] values array of values, values[i] is maped to keys[i]
+		 * @param[in] count number of pairs
+		*/
+		template <typename Q>
+		void putBatch(const Q* keys, const V* values, size_t count){
+			forEachShard(keys, count, [values](Hashtable<K,V,H,A> &table, const Q* chunk, size_t start,
+			                                   const uint32_t* indexes, const size_t* hashes, size_t n){
+				table.putHashed(chunk, values + start, indexes, hashes, n);
+			});
+		}
+
+		/** Copy the values maped to keys
+		 * Keys are grouped by shard, each shard is locked once for its
+		 * keys of a chunk. Values are copied since other threads may update
+		 * them once it is unlocked.
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] count number of keys
+		 * @param[in] values array set to copies of the values, missing if a key is not here
+		 * @param[in] missing value given for keys not in the table
+		 * @param[out] found number of keys found
+		*/
+		template <typename Q>
+		size_t getBatch(const Q* keys, size_t count, V* values, const V &missing){
+			size_t found = 0;
+			forEachShard(keys, count, [values, &missing, &found](Hashtable<K,V,H,A> &table, const Q* chunk, size_t start,
+			                                                     const uint32_t* indexes, const size_t* hashes, size_t n){
+				const V* stored[SHARDBATCH];
+				found += table.getHashed(chunk, indexes, hashes, n, stored);
+				for(size_t i = 0; i<n; ++i){
+					values[start + indexes[i]] = nullptr == stored[i] ? missing : *stored[i];
+				}
+			});
+			return found;
+		}
+
+		/** Update the values maped to keys with a function, or map the keys
+		 * not in the table to value, as upsert does for each key
+		 * Keys are grouped by shard, each shard is locked once for its
+		 * keys of a chunk, other threads can use the table meanwhile.
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] count number of keys
+		 * @param[in] value value maped to keys not here yet
+		 * @param[in] update function called with a reference to the value maped to each key already here
+		 * @param[out] inserted array set to true for each key maped to value, not here before, nullptr if unused
+		*/
+		template <typename Q, typename F>
+		void upsertBatch(const Q* keys, size_t count, const V &value, F update, bool* inserted = nullptr){
+			forEachShard(keys, count, [&value, &update, inserted](Hashtable<K,V,H,A> &table, const Q* chunk, size_t start,
+			                                                      const uint32_t* indexes, const size_t* hashes, size_t n){
+				table.upsertHashed(chunk, indexes, hashes, n, value, update, nullptr == inserted ? nullptr : inserted + start);
+			});
+		}
+
+		/** Remove the key (and its corresponding value) from this hashtable.
+		 * @param[in] key Key of the pair to delete
+		 * @exception HashtableException threw if table does not contain key
+		*/
+		template <typename Q>
+		void remove(const Q &key){
+			Shard &shard = shardOf(key);
+			std::lock_guard<std::mutex> guard(shard.lock);
+			shard.table.remove(key);
+		}
+
+		/** Call a function on every pair, as they are at one point in time
+		 * Every shard is locked (always in the same order) before the first
+		 * pair is visited, and unlocked after the last one.
+		 * @param[in] visit function called with a const reference to each pair
+		*/
+		template <typename F>
+		void forEach(F visit){
+			std::vector<std::unique_lock<std::mutex>> guards;
+			guards.reserve(_shardCount);
+			for(unsigned i = 0; i<_shardCount; ++i){
+				guards.emplace_back(_shards[i].lock);
+			}
+			for(unsigned i = 0; i<_shardCount; ++i){
+				for(const pair<const K,V> &stored : _shards[i].table){
+					visit(stored);
+				}
+			}
+		}
+};
+
+/** \brief Can a table be used by several threads at once ?
+ * value is true for ConcurrentHashtable, false for the other tables.
+*/
+template <typename T>
+struct ThreadSafe : std::false_type {};
+
+/** \brief ConcurrentHashtable can be used by several threads at once
+*/
+template <typename K, typename V, typename H, typename A>
+struct ThreadSafe<ConcurrentHashtable<K,V,H,A>> : std::true_type {};
+
+#endif // CONCURRENTHASHTABLE_HPP
@@ -0,0 +1,413 @@
+/**
+ * @file dawg.hpp
+ *
+ * @section desc File description
+ *
+ * Dawg is a minimal directed acyclic word graph : a tree of words where
+ * every shared suffix is stored once, built from words in increasing order
+ *
+ * Words are numbered in increasing order by the counts of words below each
+ * state, so a word leads to its frequency, stored apart from the graph.
+ *
+ * A graph is stored into a file as a header followed by its arrays :
+ * states, edges and frequencies.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+ */
+
+#ifndef DAWG_HPP
+#define DAWG_HPP
+
+/// macro to define the version of the graph files
+#ifndef DAWGVERSION
+#define DAWGVERSION 1
+#endif
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include "hashers.hpp"
+#include "hashtable.hpp"
+#include "treestring.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::pair;
+
+/** \brief Header of a graph file.
+ */
+struct DawgHeader {
+	char magic[8]; /** "GLOSSYDG" */
+	uint32_t version; /** DAWGVERSION of the program which wrote the file */
+	uint32_t root; /** the first state */
+	uint64_t states; /** number of states */
+	uint64_t edges; /** number of edges */
+	uint64_t words; /** number of words, i.e. of frequencies */
+	uint64_t checksum; /** wyhash of the arrays */
+};
+
+/** \brief Minimal graph of words and of their frequencies.
+ *
+ * Words are added in strictly increasing order (as unsigned chars). The
+ * states of the last word added are the only ones which can still change :
+ * when a new word leaves them, they are frozen, and replaced by an equal
+ * frozen state if there is one (same end of word, same edges), so that
+ * every suffix is stored once (Daciuk's algorithm).
+ * A frozen state knows how many words start from it, so the rank of a word
+ * among the words of the graph is counted while following its letters :
+ * it is the index of its frequency.
+ */
+class Dawg {
+
+	private:
+		/** \brief a frozen state */
+		struct State {
+			uint32_t firstEdge; /** index of the first edge of the state */
+			uint32_t words; /** number of words starting from the state */
+			uint16_t edgeCount; /** number of edges, sorted by letter */
+			bool final; /** does a word end on the state ? */
+		};
+
+		/** \brief an edge from a frozen state */
+		struct Edge {
+			uint32_t target; /** state the edge leads to */
+			uint32_t before; /** words of the state ranked before the words of the target */
+			char label; /** letter of the edge */
+		};
+
+		/** \brief a state of the last word added, which can still change */
+		struct OpenState {
+			bool final; /** does a word end on the state ? */
+			vector<pair<char,uint32_t>> edges; /** edges to frozen states, sorted by letter */
+		};
+
+		vector<State> _states; /** frozen states */
+		vector<Edge> _edges; /** edges of the frozen states, state after state */
+		vector<int> _frequencies; /** frequencies of the words, by rank */
+		uint32_t _root; /** the first state, once the graph is finished */
+		vector<OpenState> _path; /** states of the last word added, the root first */
+		string _last; /** last word added */
+		Hashtable<string,uint32_t> _register; /** frozen states, by signature */
+		string _signature; /** buffer to make the signatures of the states */
+
+		/** Freeze a state, or find an equal frozen state
+		 * @param[in] open the state
+		 * @param[out] state the frozen state
+		 */
+		uint32_t freeze(const OpenState &open){
+			// end of word then each edge, letter and target
+			_signature.assign(1, open.final ? '1' : '0');
+			for(const pair<char,uint32_t> &edge : open.edges){
+				_signature += edge.first;
+				_signature.append(reinterpret_cast<const char*>(&edge.second), sizeof(uint32_t));
+			}
+			uint32_t fresh = (uint32_t)_states.size();
+			uint32_t state = _register.upsert(string_view(_signature), fresh);
+			if(state == fresh){
+				// value initialized, the padding written into files is zero
+				State frozen = State();
+				frozen.firstEdge = (uint32_t)_edges.size();
+				frozen.edgeCount = (uint16_t)open.edges.size();
+				frozen.final = open.final;
+				frozen.words = open.final ? 1 : 0;
+				for(const pair<char,uint32_t> &edge : open.edges){
+					Edge frozenEdge = Edge();
+					frozenEdge.target = edge.second;
+					frozenEdge.before = frozen.words;
+					frozenEdge.label = edge.first;
+					_edges.push_back(frozenEdge);
+					frozen.words += _states[edge.second].words;
+				}
+				_states.push_back(frozen);
+			}
+			return state;
+		}
+
+		/** Freeze the states of the last word after a length
+		 * @param[in] length number of letters of the last word to keep open
+		 */
+		void freezeFrom(size_t length){
+			while(length+1 < _path.size()){
+				uint32_t state = freeze(_path.back());
+				_path.pop_back();
+				_path.back().edges.push_back(pair<char,uint32_t>(_last[_path.size()-1], state));
+			}
+		}
+
+		/** Follow the letters of a word from the root
+		 * Edges are searched by letter, their counts give the rank of the word.
+		 * @param[in] word the letters to follow
+		 * @param[in] state set to the state reached
+		 * @param[in] rank set to the rank, among the words of the graph, of the first word starting from state
+		 * @param[out] bool true if every letter was followed, else false
+		 */
+		bool walk(string_view word, uint32_t &state, size_t &rank) const {
+			if(not _path.empty() or _states.empty()) return false;
+			state = _root;
+			rank = 0;
+			for(char letter : word){
+				const State &current = _states[state];
+				const Edge* begin = _edges.data() + current.firstEdge;
+				const Edge* end = begin + current.edgeCount;
+				const Edge* edge = std::lower_bound(begin, end, letter, [](const Edge &e, char l){
+					return (unsigned char)e.label < (unsigned char)l;
+				});
+				if(edge == end or edge->label != letter) return false;
+				rank += edge->before;
+				state = edge->target;
+			}
+			return true;
+		}
+
+		/** Call a function on every word starting from a state
+		 * @param[in] state the state
+		 * @param[in] rank rank of the first word starting from state
+		 * @param[in] word letters leading to the state, the buffer where the words are made
+		 * @param[in] visit function called with each word and its frequency
+		 */
+		template <typename F>
+		void visitFrom(uint32_t state, size_t rank, string &word, F &visit) const {
+			const State &current = _states[state];
+			if(current.final) visit(string_view(word), _frequencies[rank]);
+			for(uint32_t e = current.firstEdge; e<current.firstEdge + current.edgeCount; ++e){
+				word.push_back(_edges[e].label);
+				visitFrom(_edges[e].target, rank + _edges[e].before, word, visit);
+				word.pop_back();
+			}
+		}
+
+		/** Check that the arrays read from a file make a graph : edges lead
+		 * to states frozen before, so there is no cycle, and the counts of
+		 * words give ranks below the number of frequencies
+		 * @exception TreeStringException threw if the graph is corrupted
+		 */
+		void check() const {
+			for(size_t s = 0; s<_states.size(); ++s){
+				const State &state = _states[s];
+				if((uint64_t)state.firstEdge + state.edgeCount > _edges.size()){
+					throw TreeStringException("Graph file is corrupted!");
+				}
+				uint32_t words = state.final ? 1 : 0;
+				for(uint32_t e = state.firstEdge; e<state.firstEdge + state.edgeCount; ++e){
+					if(_edges[e].target >= s or _edges[e].before != words){
+						throw TreeStringException("Graph file is corrupted!");
+					}
+					words += _states[_edges[e].target].words;
+				}
+				if(words != state.words) throw TreeStringException("Graph file is corrupted!");
+			}
+			if(_root >= _states.size() or _states[_root].words != _frequencies.size()){
+				throw TreeStringException("Graph file is corrupted!");
+			}
+		}
+
+	public:
+		/** Simple constructor, a graph without any word, open to add words
+		 */
+		Dawg():
+		_root(0),
+		_path(1)
+		{}
+
+		/** Constructor, minimizes the words of a tree
+		 * @param[in] tree a TreeString, or any tree with forEachWord
+		 */
+		template <typename T, typename = EnableTree<T>>
+		explicit Dawg(const T &tree):
+		Dawg()
+		{
+			// words come in increasing order
+			tree.forEachWord([this](string_view word, int frequency){
+				add(word, frequency);
+			});
+			finish();
+		}
+
+		/** Constructor, reads a graph written by save
+		 * @param[in] path path of the file
+		 * @exception TreeStringException threw if the file is missing, truncated or corrupted
+		 */
+		explicit Dawg(const string &path):
+		_root(0)
+		{
+			std::ifstream file(path, std::ios::in | std::ios::binary);
+			if(not file) throw TreeStringException("Graph file cannot be opened!");
+			DawgHeader header;
+			if(not file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+				throw TreeStringException("Graph file is truncated!");
+			}
+			if(0 != std::memcmp(header.magic, "GLOSSYDG", 8)){
+				throw TreeStringException("Not a graph file!");
+			}
+			if(DAWGVERSION != header.version){
+				throw TreeStringException("Graph file has another version!");
+			}
+			// counts are bounded before anything is allocated
+			if(0 == header.states or UINT32_MAX < header.states or UINT32_MAX < header.edges
+			   or UINT32_MAX < header.words){
+				throw TreeStringException("Graph file is corrupted!");
+			}
+			_states.resize(header.states);
+			_edges.resize(header.edges);
+			_frequencies.resize(header.words);
+			_root = header.root;
+			file.read(reinterpret_cast<char*>(_states.data()), _states.size()*sizeof(State));
+			file.read(reinterpret_cast<char*>(_edges.data()), _edges.size()*sizeof(Edge));
+			file.read(reinterpret_cast<char*>(_frequencies.data()), _frequencies.size()*sizeof(int));
+			if(not file) throw TreeStringException("Graph file is truncated!");
+			if(header.checksum != checksum()) throw TreeStringException("Graph file is corrupted!");
+			check();
+		}
+
+		/** Hashcode of the arrays, to check a file
+		 * @param[out] checksum wyhash of the arrays
+		 */
+		uint64_t checksum() const {
+			uint64_t hash = wyhash(_states.data(), _states.size()*sizeof(State), _root);
+			hash = wyhash(_edges.data(), _edges.size()*sizeof(Edge), hash);
+			return wyhash(_frequencies.data(), _frequencies.size()*sizeof(int), hash);
+		}
+
+		/** Write the finished graph into a file, read back by the path constructor
+		 * @param[in] path path of the file, replaced if it exists
+		 * @exception TreeStringException threw if the graph is not finished
+		 * or if the file cannot be written
+		 */
+		void save(const string &path) const {
+			if(not _path.empty()) throw TreeStringException("Graph must be finished to be saved!");
+			DawgHeader header;
+			std::memcpy(header.magic, "GLOSSYDG", 8);
+			header.version = DAWGVERSION;
+			header.root = _root;
+			header.states = _states.size();
+			header.edges = _edges.size();
+			header.words = _frequencies.size();
+			header.checksum = checksum();
+			std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(_states.data()), _states.size()*sizeof(State));
+			file.write(reinterpret_cast<const char*>(_edges.data()), _edges.size()*sizeof(Edge));
+			file.write(reinterpret_cast<const char*>(_frequencies.data()), _frequencies.size()*sizeof(int));
+			file.close();
+			if(not file) throw TreeStringException("Graph file cannot be written!");
+		}
+
+		/** Add a word, greater than the last word added
+		 * @param[in] word the word, not empty
+		 * @param[in] frequency frequency of the word, greater than 0
+		 * @exception TreeStringException threw if the word is not greater than
+		 * the last one, or if the graph is finished
+		 */
+		void add(string_view word, int frequency){
+			if(_path.empty()) throw TreeStringException("Words cannot be added to a finished graph!");
+			if(word.empty() or not(string_view(_last) < word)){
+				throw TreeStringException("Words must be added in increasing order!");
+			}
+			// letters shared with the last word stay open
+			size_t common = 0;
+			while(common < _last.size() and common < word.size() and _last[common] == word[common]){
+				++common;
+			}
+			freezeFrom(common);
+			_last.assign(word.data(), word.size());
+			_path.resize(word.size()+1);
+			for(size_t i = common+1; i<=word.size(); ++i){
+				_path[i].final = false;
+				_path[i].edges.clear();
+			}
+			_path.back().final = true;
+			_frequencies.push_back(frequency);
+		}
+
+		/** Freeze every state, no word can be added afterwards
+		 */
+		void finish(){
+			if(_path.empty()) return;
+			freezeFrom(0);
+			_root = freeze(_path[0]);
+			_path.clear();
+			_register.clear();
+			string().swap(_signature);
+		}
+
+		/** Number of words
+		 * @param[out] count number of different words
+		 */
+		size_t size() const { return _frequencies.size(); }
+
+		/** Number of states of the graph, once it is finished
+		 * @param[out] count number of frozen states
+		 */
+		size_t stateCount() const { return _states.size(); }
+
+		/** Number of edges of the graph, once it is finished
+		 * @param[out] count number of edges
+		 */
+		size_t edgeCount() const { return _edges.size(); }
+
+		/** Is a word in the graph ?
+		 * @param[in] word the word to look for
+		 * @param[out] bool true if the word is in the finished graph, else false
+		 */
+		bool contains(string_view word) const {
+			return 0 < frequency(word);
+		}
+
+		/** Frequency of a word
+		 * Edges are searched by letter, their counts give the rank of the word.
+		 * @param[in] word the word to look for
+		 * @param[out] frequency frequency of the word, 0 if absent or if the graph is not finished
+		 */
+		int frequency(string_view word) const {
+			uint32_t state;
+			size_t rank;
+			if(word.empty() or not walk(word, state, rank)) return 0;
+			return _states[state].final ? _frequencies[rank] : 0;
+		}
+
+		/** Call a function on every word starting with a prefix, in
+		 * increasing order of their letters as unsigned chars
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[in] visit function called with each word, as a string_view
+		 * valid during the call only, and its frequency
+		 */
+		template <typename F>
+		void forEachWithPrefix(string_view prefix, F visit) const {
+			uint32_t state;
+			size_t rank;
+			if(not walk(prefix, state, rank)) return;
+			string word(prefix);
+			visitFrom(state, rank, word, visit);
+		}
+};
+
+#endif // DAWG_HPP
@@ -38,31 +38,128 @@
 #define DICTIONNAIRE_HPP
 
 #include "treestring.hpp"
+#include "radixtreestring.hpp"
+#include "doublearraytrie.hpp"
+#include "dawg.hpp"
+#include "bloomfilter.hpp"
+#include "classement.hpp"
+#include <vector>
 #include <utility>
+#include <string_view>
+
+using std::string_view;
+using std::vector;
+
+/// arbre utilisé par le dictionnaire : TreeString ou RadixTreeString
+#ifndef DICOARBRE
+#define DICOARBRE TreeString
+#endif
+
+/// arbre figé enregistré par Dictionnaire::sauvegarder et lu par
+/// DictionnaireFige : DoubleArrayTrie ou Dawg, plus petit pour les grands
+/// vocabulaires, chaque suffixe commun des mots n'y étant stocké qu'une fois
+#ifndef DICOFIGE
+#define DICOFIGE DoubleArrayTrie
+#endif
+
+/// définir DICOFILTRE pour rejeter les mots absents avec un filtre de Bloom,
+/// dimensionné pour DICOFILTREMOTS mots
+#ifndef DICOFILTREMOTS
+#define DICOFILTREMOTS 1048576
+#endif
 
 /**
- * Fonction qui permet de trier un container de pairs construit
- * avec des strings et des entiers. Le critère de tri est l'ordre naturel
- * sur les entiers appliqué à l'entier de la pair.
- * @param[in] first la première pair à comparer
- * @param[in] second la seconde pair à comparer
- * @param[out] bool vrai si first>seconde sinon faux
+ * Statistiques de l'arbre d'un dictionnaire
  */
-bool triPair(const pair<string, int> &first, const pair<string, int> &second){
-	return first.second > second.second;
-}
+struct StatistiquesArbre {
+	size_t mots; /** nombre de mots différents */
+	size_t noeuds; /** nombre de noeuds de l'arbre, la racine comprise */
+	int hauteur; /** hauteur de l'arbre, en noeuds */
+
+	/**
+	 * Fonction qui renvoie une description des statistiques, une par ligne
+	 * @param[out] desc les statistiques
+	 */
+	string toString() const {
+		return "mots: " + std::to_string(mots)
+			+ "\nnoeuds: " + std::to_string(noeuds)
+			+ "\nhauteur: " + std::to_string(hauteur) + "\n";
+	}
+};
 
 class Dictionnaire{
 	
 	private :
-		TreeString dico;
+		DICOARBRE dico;
+#ifdef DICOFILTRE
+		/** filtre rejetant la plupart des mots absents sans parcourir l'arbre */
+		BloomFilter<string> filtre;
+#endif
+
+		/**
+		 * Fonction qui ajoute un mot au filtre de Bloom, s'il y en a un
+		 * @param[in] mot le mot ajouté au dictionnaire
+		 */
+		void filtrer(string_view mot){
+#ifdef DICOFILTRE
+			filtre.add(mot);
+#else
+			(void)mot;
+#endif
+		}
+
+		/**
+		 * Fonction qui ajoute des mots à un arbre, avec plusieurs threads
+		 * si l'arbre le permet
+		 * @param[in] arbre l'arbre du dictionnaire
+		 * @param[in] mots les mots à ajouter
+		 * @param[in] nbThreads nombre de threads à utiliser
+		 */
+		template <typename A>
+		static void ajouterMots(A &arbre, const vector<string> &mots, unsigned nbThreads){
+			if constexpr(ParallelPut<A>::value){
+				arbre.putAll(mots, nbThreads);
+			}
+			else {
+				(void)nbThreads;
+				for(const string &mot : mots){
+					arbre.put(mot);
+				}
+			}
+		}
+
+		/**
+		 * Fonction qui renvoie faux si le filtre de Bloom sait que le mot
+		 * est absent, une seule ligne de cache est lue
+		 * @param[in] mot le mot à tester
+		 * @param[out] bool faux si le mot est absent, vrai s'il peut être présent
+		 */
+		bool peutContenir(string_view mot){
+#ifdef DICOFILTRE
+			return filtre.mayContain(mot);
+#else
+			(void)mot;
+			return true;
+#endif
+		}
 
 	public :
 	
+#ifdef DICOFILTRE
+		/**
+		 * Constructeur de la classe Dictionnaire
+		 * @param[in] motsAttendus nombre de mots pour lequel le filtre est dimensionné
+		 * @param[in] tauxFauxPositifs proportion de mots absents non rejetés par le filtre
+		 */
+		Dictionnaire(size_t motsAttendus = DICOFILTREMOTS, double tauxFauxPositifs = BLOOMRATE):
+		filtre(motsAttendus, tauxFauxPositifs)
+		{}
+#else
 		/**
 		 * Constructeur de la classe Dictionnaire
 		 */
 		Dictionnaire(){}
+#endif
 		
 		/**
 		 * Destructeur de la classe Dictionnaire
@@ -74,25 +171,16 @@ class Dictionnaire{
 		 * @param[in] mot le mot à tester
 		 * @param[out] bool vrai si présent, faux sinon.
 		 */
-		bool contientMot(string mot){
-			bool trouve=false;
-			forward_list<string> list;
-			dico.getWords(list);
-			auto it = list.begin();
-			while(it!=list.end() and !trouve){
-				trouve = (it->compare(mot)==0);
-				++it;
-			}
-			return trouve;
-			
+		bool contientMot(string_view mot){
+			return peutContenir(mot) and dico.contains(mot);
 		}			
 		
 		/**
 		 * Fonction qui ajoute un mot non présent dans le dictionnaire
 		 * @param[in] mot le mot à ajouter
 		 */
-		void ajouterMot(string mot){
-			dico.put(mot);
+		void ajouterMot(string_view mot){
+			incrementer(mot);
 		}	
 
 		/**
@@ -100,26 +188,59 @@ class Dictionnaire{
 		 * @param[in] mot le mot à modifier
 		 * @param[out] bool Renvoyer faux si le mot n'est pas présent, sinon vrai
 		 */
-		void associerMot(string mot){
-			dico.put(mot);
+		void associerMot(string_view mot){
+			incrementer(mot);
 		}	
+
+		/**
+		 * Fonction qui compte une occurence d'un mot, qu'il soit présent
+		 * ou non dans le dictionnaire. L'arbre n'est parcouru qu'une fois,
+		 * le mot n'est ajouté au filtre que s'il est nouveau.
+		 * @param[in] mot le mot à compter
+		 */
+		void incrementer(string_view mot){
+			if(1 == dico.put(mot)){
+				filtrer(mot);
+			}
+		}
+
+		/**
+		 * Fonction qui compte les occurences d'un bloc de mots consécutifs.
+		 * @param[in] mots adresse du premier mot du bloc
+		 * @param[in] nb nombre de mots du bloc
+		 */
+		void incrementerBloc(const string *mots, size_t nb){
+			for(size_t i = 0; i<nb; ++i){
+				incrementer(mots[i]);
+			}
+		}
+
+		/**
+		 * Fonction qui compte les occurences d'une suite de mots.
+		 * Les mots sont répartis entre plusieurs threads si l'arbre le
+		 * permet (TreeString::putAll), sinon ils sont comptés par un seul.
+		 * Le filtre est ensuite rempli une fois avec les mots de l'arbre,
+		 * plutôt qu'avec chaque occurence.
+		 * @param[in] mots les mots à compter
+		 * @param[in] nbThreads nombre de threads à utiliser
+		 */
+		void incrementerMots(const vector<string> &mots, unsigned nbThreads){
+			ajouterMots(dico, mots, nbThreads);
+#ifdef DICOFILTRE
+			dico.forEachWord([this](string_view mot, int){
+				filtre.add(mot);
+			});
+#endif
+		}
 			
 		/**
 		 * Fonction qui récupère la valeur associée au mot
 		 * @param[in] mot le mot dont on souhaite savoir la valeur associée
-		 * @param[out] valeur la valeur associée
-		 * @exception lève une exception si le mot n'est pas présent dans le dictionnaire
-		 */
-		int valeurAssociee(string mot){
-			bool trouve=false;
-			forward_list<pair<string,int>> words;
-			dico.getWordsFrequencies(words);
-			auto it = words.begin();
-			while(it!=words.end() and !trouve){
-				trouve = ((it->first).compare(mot)==0);
-				++it;
-			}
-			return it->second;
+		 * @param[out] valeur la valeur associée, 0 si le mot n'est pas présent
+		 */
+		int valeurAssociee(string_view mot){
+			if(not peutContenir(mot)) return 0;
+			return dico.frequency(mot);
 		}
 				
 		/**
@@ -127,18 +248,107 @@ class Dictionnaire{
 		 * @param[int] frequences tableau des paires<mots,occurences> les plus fréquents
 		 */
 		void plusFrequentes(pair<string,int> *frequences){
-			forward_list<pair<string, int>> pairs;
-			// on récupère les mots avec leurs fréquences
-			dico.getWordsFrequencies(pairs);
-			// on tri la liste
-			pairs.sort(&triPair); // complexité : n(log(n))
-			auto it_pairs = pairs.begin();
-			int i = 0;
-			// on met les dix premières pairs dans le tableau
-			while(i<10 and pairs.end() != it_pairs){
-				frequences[i++] = *it_pairs;
-				++it_pairs;
-			}
+			int nb = 0; // nombre de paires déjà dans le tableau
+			// les mots sont parcourus sans construire de liste
+			dico.forEachWord([frequences, &nb](string_view mot, int occurences){
+				classerMot(frequences, nb, mot, occurences);
+			});
+		}
+
+		/**
+		 * Fonction qui fige l'arbre en un DICOFIGE et l'enregistre
+		 * dans un fichier, qui pourra être ouvert par un DictionnaireFige
+		 * @param[in] chemin chemin du fichier, remplacé s'il existe
+		 * @exception TreeStringException si le fichier ne peut être écrit
+		 */
+		void sauvegarder(const string &chemin){
+			DICOFIGE(dico).save(chemin);
+		}
+
+		/**
+		 * Fonction qui renvoie les statistiques de l'arbre : mots, noeuds et
+		 * hauteur, les mots sont comptés en parcourant l'arbre
+		 * @param[out] stats les statistiques de l'arbre
+		 */
+		StatistiquesArbre statistiques(){
+			StatistiquesArbre stats;
+			stats.mots = 0;
+			dico.forEachWord([&stats](string_view, int){ ++stats.mots; });
+			stats.noeuds = dico.nodeCount();
+			stats.hauteur = dico.height();
+			return stats;
+		}
+
+#ifdef DICOFILTRE
+		/**
+		 * Fonction qui renvoie les statistiques du filtre de Bloom :
+		 * remplissage, taux de faux positifs estimé et mots rejetés
+		 * @param[out] stats les statistiques du filtre
+		 */
+		BloomStats statistiquesFiltre(){
+			return filtre.stats();
+		}
+#endif
+};
+
+/**
+ * Dictionnaire en lecture seule, ouvert depuis un fichier écrit par
+ * Dictionnaire::sauvegarder. L'arbre y est figé en double tableau : chaque
+ * lettre d'un mot est suivie en lisant deux cases, sans pointeur ; ou en
+ * graphe (Dawg) si DICOFIGE vaut Dawg.
+ */
+class DictionnaireFige{
+
+	private :
+		/** arbre figé lu depuis le fichier */
+		DICOFIGE dico;
+
+	public :
+
+		/**
+		 * Constructeur de la classe DictionnaireFige
+		 * @param[in] chemin chemin du fichier écrit par Dictionnaire::sauvegarder
+		 * @exception TreeStringException si le fichier est absent ou corrompu
+		 */
+		explicit DictionnaireFige(const string &chemin):
+		dico(chemin)
+		{}
+
+		/**
+		 * Fonction qui renvoie vrai le mot est présent dans le Dictionnaire
+		 * @param[in] mot le mot à tester
+		 * @param[out] bool vrai si présent, faux sinon.
+		 */
+		bool contientMot(string_view mot){
+			return dico.contains(mot);
+		}
+
+		/**
+		 * Fonction qui renvoie le nombre de mots différents du dictionnaire
+		 * @param[out] nb nombre de mots
+		 */
+		unsigned nombreMots(){
+			return dico.size();
+		}
+
+		/**
+		 * Fonction qui récupère la valeur associée au mot
+		 * @param[in] mot le mot dont on souhaite savoir la valeur associée
+		 * @param[out] valeur la valeur associée, 0 si le mot n'est pas présent
+		 */
+		int valeurAssociee(string_view mot){
+			return dico.frequency(mot);
+		}
+
+		/**
+		 * Fonction qui retourne les dix mots les plus fréquents dans un tableau
+		 * @param[int] frequences tableau des paires<mots,occurences> les plus fréquents
+		 */
+		void plusFrequentes(pair<string,int> *frequences){
+			int nb = 0; // nombre de paires déjà dans le tableau
+			dico.forEachWithPrefix(string_view(), [frequences, &nb](string_view mot, int occurences){
+				classerMot(frequences, nb, mot, occurences);
+			});
 		}
 };
 
@@ -36,36 +36,140 @@
 
  
 #include "hashtable.hpp"
+#include "flathashtable.hpp"
+#include "concurrenthashtable.hpp"
+#include "lockfreecountermap.hpp"
+#include "bloomfilter.hpp"
+#include "classement.hpp"
+#include "internedstring.hpp"
+#include "mappedhashtable.hpp"
+#include <thread>
+#include <vector>
 #include <utility>
+#include <string_view>
+
+/// table utilisée pour stocker les mots : Hashtable, FlatHashtable, ou
+/// ConcurrentHashtable et LockFreeCounterMap pour compter les mots avec
+/// plusieurs threads, LockFreeCounterMap sans aucun verrou
+#ifndef DICOTABLE
+#define DICOTABLE Hashtable
+#endif
+
+/// type des mots stockés dans la table : string, ou InternedString
+/// pour stocker les mots courts dans les alvéoles et les autres une seule fois
+#ifndef DICOCLE
+#define DICOCLE string
+#endif
+
+/// nombre de mots donnés à la fois à la table par incrementerMots
+#ifndef MOTSPARBLOC
+#define MOTSPARBLOC 256
+#endif
+
+/// définir DICOFILTRE pour rejeter les mots absents avec un filtre de Bloom,
+/// dimensionné pour DICOFILTREMOTS mots
+#ifndef DICOFILTREMOTS
+#define DICOFILTREMOTS 1048576
+#endif
 
  
 using std::pair;
+using std::string_view;
+using std::vector;
 
 
-/**
- * Fonction qui permet de trier un container de pairs construit
- * avec des strings et des entiers. Le critère de tri est l'ordre naturel
- * sur les entiers appliqué à l'entier de la pair.
- * @param[in] first la première pair à comparer
- * @param[in] second la seconde pair à comparer
- * @param[out] bool vrai si first>seconde sinon faux
- */
-bool triPair(const pair<string, int> &first, const pair<string, int> &second){
-	return first.second > second.second;
-}
-
 class Dictionnaire{
 	
 	private :
 		/** stockage des mots dans une table de hashage */
-		Hashtable<string,int> dico;
+		DICOTABLE<DICOCLE,int> dico;
+#ifdef DICOFILTRE
+		/** filtre rejetant la plupart des mots absents sans chercher dans la table */
+		BloomFilter<string> filtre;
+#endif
+
+		/**
+		 * Fonction qui ajoute un mot au filtre de Bloom, s'il y en a un
+		 * @param[in] mot le mot ajouté au dictionnaire
+		 */
+		void filtrer(string_view mot){
+#ifdef DICOFILTRE
+			filtre.add(mot);
+#else
+			(void)mot;
+#endif
+		}
+
+		/**
+		 * Fonction qui compte une occurence d'un mot dans une table : une
+		 * seule addition atomique si la table le permet (LockFreeCounterMap),
+		 * sinon un upsert
+		 * @param[in] table la table du dictionnaire
+		 * @param[in] mot le mot à compter
+		 * @param[out] nb nombre d'occurences du mot après l'ajout, 1 s'il est nouveau
+		 */
+		template <typename T>
+		static int compter(T &table, string_view mot){
+			if constexpr(AtomicCounters<T>::value){
+				return table.increment(mot);
+			}
+			else {
+				return table.upsert(mot,1,[](int &valeur){ ++valeur; });
+			}
+		}
+
+		/**
+		 * Fonction qui compte une occurence de chaque mot d'un bloc dans
+		 * une table, comme compter
+		 * @param[in] table la table du dictionnaire
+		 * @param[in] mots adresse du premier mot du bloc
+		 * @param[in] nb nombre de mots du bloc
+		 * @param[in] nouveaux nouveaux[i] mis à vrai si mots[i] n'était pas encore dans la table
+		 */
+		template <typename T>
+		static void compterBloc(T &table, const string *mots, size_t nb, bool *nouveaux){
+			if constexpr(AtomicCounters<T>::value){
+				for(size_t i = 0; i<nb; ++i){
+					table.increment(mots[i], 1, nouveaux[i]);
+				}
+			}
+			else {
+				table.upsertBatch(mots, nb, 1, [](int &valeur){ ++valeur; }, nouveaux);
+			}
+		}
+
+		/**
+		 * Fonction qui renvoie faux si le filtre de Bloom sait que le mot
+		 * est absent, une seule ligne de cache est lue
+		 * @param[in] mot le mot à tester
+		 * @param[out] bool faux si le mot est absent, vrai s'il peut être présent
+		 */
+		bool peutContenir(string_view mot){
+#ifdef DICOFILTRE
+			return filtre.mayContain(mot);
+#else
+			(void)mot;
+			return true;
+#endif
+		}
 
 	public :
 	
+#ifdef DICOFILTRE
+		/**
+		 * Constructeur de la classe Dictionnaire
+		 * @param[in] motsAttendus nombre de mots pour lequel le filtre est dimensionné
+		 * @param[in] tauxFauxPositifs proportion de mots absents non rejetés par le filtre
+		 */
+		Dictionnaire(size_t motsAttendus = DICOFILTREMOTS, double tauxFauxPositifs = BLOOMRATE):
+		filtre(motsAttendus, tauxFauxPositifs)
+		{}
+#else
 		/**
 		 * Constructeur de la classe Dictionnaire
 		 */
 		Dictionnaire(){}
+#endif
 		
 		
 		/**
@@ -78,15 +182,24 @@ class Dictionnaire{
 		 * @param[in] mot le mot à tester
 		 * @param[out] bool vrai si présent, faux sinon.
 		 */
-		bool contientMot(string mot){
-			return dico.contains(mot);
+		bool contientMot(string_view mot){
+			return peutContenir(mot) and dico.contains(mot);
 		}
 		
+		/**
+		 * Fonction qui renvoie le nombre de mots différents du dictionnaire
+		 * @param[out] nb nombre de mots
+		 */
+		unsigned nombreMots(){
+			return dico.size();
+		}
+
 		/**
 		 * Fonction qui ajoute un mot non présent dans le dictionnaire
 		 * @param[in] mot le mot à ajouter
 		 */
-		void ajouterMot(string mot){
+		void ajouterMot(string_view mot){
+			filtrer(mot);
 			dico.put(mot,1);
 		}	
 
@@ -95,8 +208,79 @@ class Dictionnaire{
 		 * @param[in] mot le mot à modifier
 		 * @param[out] bool Renvoyer faux si le mot n'est pas présent, sinon vrai
 		 */
-		void associerMot(string mot){
-			dico.put(mot,dico.get(mot)+1);
+		void associerMot(string_view mot){
+			incrementer(mot);
+		}
+
+		/**
+		 * Fonction qui compte une occurence d'un mot, qu'il soit présent
+		 * ou non dans le dictionnaire. Le mot n'est cherché qu'une fois,
+		 * il n'est ajouté au filtre que s'il est nouveau.
+		 * @param[in] mot le mot à compter
+		 */
+		void incrementer(string_view mot){
+			if(1 == compter(dico, mot)){
+				filtrer(mot);
+			}
+		}
+
+		/**
+		 * Fonction qui compte les occurences d'un bloc de mots consécutifs.
+		 * La table cherche les alvéoles des mots d'un bloc en même temps,
+		 * les accès mémoire de plusieurs mots se recouvrent. Seuls les
+		 * mots nouveaux sont ajoutés au filtre.
+		 * @param[in] mots adresse du premier mot du bloc
+		 * @param[in] nb nombre de mots du bloc, au plus MOTSPARBLOC
+		 */
+		void incrementerBloc(const string *mots, size_t nb){
+			bool nouveaux[MOTSPARBLOC];
+			compterBloc(dico, mots, nb, nouveaux);
+			for(size_t i = 0; i<nb; ++i){
+				if(nouveaux[i]){
+					filtrer(mots[i]);
+				}
+			}
+		}
+
+		/**
+		 * Fonction qui compte les occurences de mots consécutifs,
+		 * par blocs de MOTSPARBLOC mots
+		 * @param[in] mots adresse du premier mot
+		 * @param[in] nb nombre de mots
+		 */
+		void incrementerBlocs(const string *mots, size_t nb){
+			for(size_t debut = 0; debut<nb; debut += MOTSPARBLOC){
+				incrementerBloc(mots + debut, nb - debut < MOTSPARBLOC ? nb - debut : MOTSPARBLOC);
+			}
+		}
+
+		/**
+		 * Fonction qui compte les occurences d'une suite de mots, par blocs.
+		 * Les mots sont répartis entre plusieurs threads si la table le
+		 * permet (ConcurrentHashtable, LockFreeCounterMap), sinon ils sont
+		 * comptés par un seul.
+		 * @param[in] mots les mots à compter
+		 * @param[in] nbThreads nombre de threads à utiliser
+		 */
+		void incrementerMots(const vector<string> &mots, unsigned nbThreads){
+			if(not ThreadSafe<DICOTABLE<DICOCLE,int>>::value or 2 > nbThreads){
+				incrementerBlocs(mots.data(), mots.size());
+			}
+			else {
+				vector<std::thread> threads;
+				size_t part = (mots.size() + nbThreads - 1)/nbThreads;
+				for(unsigned t = 0; t<nbThreads; ++t){
+					// chaque thread compte une tranche contiguë des mots
+					size_t debut = t*part < mots.size() ? t*part : mots.size();
+					size_t fin = debut + part < mots.size() ? debut + part : mots.size();
+					threads.emplace_back([this, &mots, debut, fin](){
+						incrementerBlocs(mots.data() + debut, fin - debut);
+					});
+				}
+				for(std::thread &thread : threads){
+					thread.join();
+				}
+			}
 		}
 		
 		/**
@@ -104,10 +288,11 @@ class Dictionnaire{
 		 * @param[in] mot le mot dont on souhaite savoir la valeur associée
 		 * @param[out] valeur la valeur associée, 0 peut indiquer l'absence du mot
 		 */
-		int valeurAssociee(string mot){
+		int valeurAssociee(string_view mot){
+			if(not peutContenir(mot)) return 0;
 			try{
-				return dico.get(mot);;
-			}catch(HashtableException e){
+				return dico.get(mot);
+			}catch(HashtableException &e){
 				return 0;
 			}
 		}
@@ -117,28 +302,107 @@ class Dictionnaire{
 		 * @param[int] frequences tableau des paires<mots,occurences> les plus fréquents
 		 */
 		void plusFrequentes(pair<string,int> *frequences){
-			forward_list<pair<string, int>> pairs;
-			// on récupère les mots avec leurs fréquences
-			dico.getPairs(pairs);
-			// on tri la liste
-			pairs.sort(&triPair); // complexité : n(log(n))
-			auto it_pairs = pairs.begin();
-			int i = 0;
-			// on met les dix premières pairs dans le tableau
-			while(i<10 and pairs.end() != it_pairs){
-				frequences[i++] = *it_pairs;
-				++it_pairs;
-			}
+			int nb = 0; // nombre de paires déjà dans le tableau
+			// on parcourt la table sans copier les mots,
+			// seuls les dix plus fréquents sont copiés dans le tableau
+			dico.forEach([frequences, &nb](const auto &mot){
+				classerMot(frequences, nb, mot.first, mot.second);
+			});
+		}
+
+		/**
+		 * Fonction qui enregistre le dictionnaire dans un fichier, qui
+		 * pourra être ouvert sans relire les mots par un DictionnaireFige
+		 * @param[in] chemin chemin du fichier, remplacé s'il existe
+		 * @exception HashtableException si le fichier ne peut être écrit
+		 */
+		void sauvegarder(const string &chemin){
+			saveSnapshot(dico, chemin);
 		}
+
+		/**
+		 * Fonction qui renvoie les statistiques de la table : répartition des
+		 * mots dans les alvéoles, et compteurs si HASHTABLE_STATS est défini
+		 * @param[out] stats les statistiques de la table
+		 */
+		TableStats statistiques(){
+			return dico.stats();
+		}
+
+#ifdef DICOFILTRE
+		/**
+		 * Fonction qui renvoie les statistiques du filtre de Bloom :
+		 * remplissage, taux de faux positifs estimé et mots rejetés
+		 * @param[out] stats les statistiques du filtre
+		 */
+		BloomStats statistiquesFiltre(){
+			return filtre.stats();
+		}
+#endif
 };
 
 /**
- * Fonction pour calculer les clés de hashage de string
+ * Dictionnaire en lecture seule, ouvert depuis un fichier écrit par
+ * Dictionnaire::sauvegarder. Le fichier est projeté en mémoire : les mots
+ * sont cherchés dès l'ouverture, sans les relire ni les ajouter un à un.
  */
-template<> unsigned computehash<string>(string element){
-	// calcul de la clé de hachage en utilisant fonction fournie par API
-	std::hash<string> hashcalculator;
-	return hashcalculator(element);
-}
+class DictionnaireFige{
+
+	private :
+		/** table projetée depuis le fichier */
+		MappedHashtable<int> dico;
+
+	public :
+
+		/**
+		 * Constructeur de la classe DictionnaireFige
+		 * @param[in] chemin chemin du fichier écrit par Dictionnaire::sauvegarder
+		 * @exception HashtableException si le fichier est absent ou corrompu
+		 */
+		explicit DictionnaireFige(const string &chemin):
+		dico(chemin)
+		{}
+
+		/**
+		 * Fonction qui renvoie vrai le mot est présent dans le Dictionnaire
+		 * @param[in] mot le mot à tester
+		 * @param[out] bool vrai si présent, faux sinon.
+		 */
+		bool contientMot(string_view mot){
+			return dico.contains(mot);
+		}
+
+		/**
+		 * Fonction qui renvoie le nombre de mots différents du dictionnaire
+		 * @param[out] nb nombre de mots
+		 */
+		unsigned nombreMots(){
+			return dico.size();
+		}
+
+		/**
+		 * Fonction qui récupère la valeur associée au mot
+		 * @param[in] mot le mot dont on souhaite savoir la valeur associée
+		 * @param[out] valeur la valeur associée, 0 peut indiquer l'absence du mot
+		 */
+		int valeurAssociee(string_view mot){
+			try{
+				return dico.get(mot);
+			}catch(HashtableException &e){
+				return 0;
+			}
+		}
+
+		/**
+		 * Fonction qui retourne les dix mots les plus fréquents dans un tableau
+		 * @param[int] frequences tableau des paires<mots,occurences> les plus fréquents
+		 */
+		void plusFrequentes(pair<string,int> *frequences){
+			int nb = 0; // nombre de paires déjà dans le tableau
+			dico.forEach([frequences, &nb](string_view mot, int occurences){
+				classerMot(frequences, nb, mot, occurences);
+			});
+		}
+};
 
 #endif // DICTIONNAIRE_HPP
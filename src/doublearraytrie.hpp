@@ -0,0 +1,467 @@
+/**
+ * @file doublearraytrie.hpp
+ *
+ * @section desc File description
+ *
+ * DoubleArrayTrie is a read-only tree of words and of their frequencies,
+ * frozen from a TreeString into two arrays : a letter is followed with
+ * two array reads, without any pointer
+ *
+ * A trie is stored into a file as a header followed by its arrays :
+ * units (base and check of each state), frequencies, first children and
+ * next siblings.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+ */
+
+#ifndef DOUBLEARRAYTRIE_HPP
+#define DOUBLEARRAYTRIE_HPP
+
+/// macro to define the version of the double-array trie files
+#ifndef DATRIEVERSION
+#define DATRIEVERSION 1
+#endif
+
+/// macro to define how many unused units a search of base may try before
+/// the units before the base found are not searched anymore
+#ifndef DATRIETRIES
+#define DATRIETRIES 32
+#endif
+
+#include <queue>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <forward_list>
+#include "hashers.hpp"
+#include "treestring.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::forward_list;
+using std::pair;
+
+/** \brief Header of a double-array trie file.
+ */
+struct DoubleArrayHeader {
+	char magic[8]; /** "GLOSSYDA" */
+	uint32_t version; /** DATRIEVERSION of the program which wrote the file */
+	uint32_t units; /** number of states, used or not */
+	uint64_t words; /** number of words */
+	uint64_t checksum; /** wyhash of the arrays */
+};
+
+/** \brief Read-only tree of words, as a double array.
+ *
+ * Each state is a unit of the array : the child of state s for the letter
+ * c is the state t = base(s) + code(c), if check(t) is s. Children of a
+ * state are also linked by their codes (first child, next sibling) to
+ * list the words without trying every letter.
+ * The trie is built from the words of a tree and their frequencies, and
+ * cannot be changed afterwards.
+ */
+class DoubleArrayTrie {
+
+	private:
+		/** \brief a state of the trie */
+		struct Unit {
+			int32_t base; /** children of the state are at base plus the code of their letter */
+			int32_t check; /** parent of the state, -1 if the unit is unused */
+		};
+
+		/// state of the empty word
+		static constexpr uint32_t ROOT = 0;
+
+		vector<Unit> _units; /** states of the trie */
+		vector<int> _frequencies; /** frequency of the word ending with each state, 0 if none */
+		vector<uint16_t> _firstChild; /** code of the first child of each state, 0 if none */
+		vector<uint16_t> _nextSibling; /** code of the next child of the parent of each state, 0 if none */
+		uint64_t _words; /** number of words */
+		vector<uint32_t> _skip; /** while building, leads from a unit to the first unused one after it */
+		size_t _searchFrom; /** while building, bases are searched from this unit */
+
+		/** Code of a letter, from 1 to 256 so base(s) + code is never s
+		 * @param[in] letter the letter
+		 * @param[out] code the code of the letter
+		 */
+		static uint32_t code(char letter){ return (uint32_t)(unsigned char)letter + 1; }
+
+		/** Child of a state
+		 * @param[in] state the state
+		 * @param[in] letter letter of the child
+		 * @param[out] child the child, ROOT if none
+		 */
+		uint32_t child(uint32_t state, char letter) const {
+			uint32_t next = (uint32_t)_units[state].base + code(letter);
+			if(next < _units.size() and (int32_t)state == _units[next].check) return next;
+			return ROOT;
+		}
+
+		/** State reached by a word
+		 * @param[in] word the word
+		 * @param[in] state set to the state of the word
+		 * @param[out] bool false if no word starts with word, else true
+		 */
+		bool walk(string_view word, uint32_t &state) const {
+			state = ROOT;
+			for(char letter : word){
+				state = child(state, letter);
+				if(ROOT == state) return false;
+			}
+			return true;
+		}
+
+		/** Make the arrays at least as large as a number of units
+		 * @param[in] size number of units
+		 */
+		void reserveUnits(size_t size){
+			if(_units.size() < size){
+				size_t grown = _units.size() < 256 ? 256 : _units.size();
+				while(grown < size) grown *= 2;
+				_units.resize(grown, Unit{0, -1});
+				_frequencies.resize(grown, 0);
+				_firstChild.resize(grown, 0);
+				_nextSibling.resize(grown, 0);
+				// one more unit, never used, ends the search of unused units
+				for(size_t i = _skip.size(); i<=grown; ++i) _skip.push_back((uint32_t)i);
+			}
+		}
+
+		/** Find the first unused unit, growing the arrays if needed
+		 * @param[in] from first unit which may be returned
+		 * @param[out] unit the first unused unit from this one
+		 */
+		size_t nextFree(size_t from){
+			reserveUnits(from+1);
+			size_t unit = from;
+			while(_skip[unit] != unit){
+				// halve the path for the next searches
+				_skip[unit] = _skip[_skip[unit]];
+				unit = _skip[unit];
+			}
+			return unit;
+		}
+
+		/** Use a unit as a child of a state
+		 * @param[in] unit the unit, unused
+		 * @param[in] state the parent state
+		 */
+		void use(size_t unit, uint32_t state){
+			_units[unit].check = (int32_t)state;
+			_skip[unit] = (uint32_t)(unit+1);
+		}
+
+		/** Find a base where every code of the children lands on an unused unit
+		 * @param[in] codes codes of the children, increasing
+		 * @param[out] base the base
+		 */
+		int32_t findBase(const vector<uint32_t> &codes){
+			// only bases putting the first child on an unused unit are tried
+			size_t unit = nextFree(codes[0] < _searchFrom ? _searchFrom : codes[0] + 1);
+			unsigned tries = 0;
+			while(true){
+				size_t base = unit - codes[0];
+				reserveUnits(base + codes.back() + 1);
+				bool free = true;
+				for(size_t i = 1; i<codes.size() and free; ++i){
+					free = -1 == _units[base + codes[i]].check;
+				}
+				if(free){
+					// the units left unused before are too few to be worth searching again
+					if(DATRIETRIES < tries) _searchFrom = unit;
+					return (int32_t)base;
+				}
+				unit = nextFree(unit+1);
+				++tries;
+			}
+		}
+
+		/** Place the children of a state, then their subtrees
+		 * @param[in] words every word, sorted
+		 * @param[in] begin first word starting with the word of the state
+		 * @param[in] end past the last word starting with the word of the state
+		 * @param[in] depth length of the word of the state
+		 * @param[in] state the state
+		 */
+		void build(const vector<pair<string,int>> &words, size_t begin, size_t end, size_t depth, uint32_t state){
+			// words are sorted, the word of the state comes first
+			if(begin < end and words[begin].first.size() == depth){
+				_frequencies[state] = words[begin].second;
+				++begin;
+			}
+			if(begin == end) return;
+			vector<uint32_t> codes;
+			vector<size_t> bounds;
+			for(size_t i = begin; i<end; ++i){
+				uint32_t c = code(words[i].first[depth]);
+				if(codes.empty() or codes.back() != c){
+					codes.push_back(c);
+					bounds.push_back(i);
+				}
+			}
+			bounds.push_back(end);
+			int32_t base = findBase(codes);
+			_units[state].base = base;
+			for(size_t i = 0; i<codes.size(); ++i){
+				use(base + codes[i], state);
+				_nextSibling[base + codes[i]] = i+1 < codes.size() ? (uint16_t)codes[i+1] : 0;
+			}
+			_firstChild[state] = (uint16_t)codes[0];
+			for(size_t i = 0; i<codes.size(); ++i){
+				build(words, bounds[i], bounds[i+1], depth+1, base + codes[i]);
+			}
+		}
+
+		/** Call a function on every word below a state
+		 * @param[in] state the state
+		 * @param[in] word letters of the state, the buffer where the words are made
+		 * @param[in] visit function called with each word and its frequency
+		 */
+		template <typename F>
+		void visitFrom(uint32_t state, string &word, F &visit) const {
+			if(0 < _frequencies[state]) visit(string_view(word), _frequencies[state]);
+			uint32_t c = _firstChild[state];
+			while(0 != c){
+				uint32_t next = (uint32_t)_units[state].base + c;
+				word.push_back((char)(c-1));
+				visitFrom(next, word, visit);
+				word.pop_back();
+				c = _nextSibling[next];
+			}
+		}
+
+	public:
+		/** Simple constructor, a trie without any word
+		 */
+		DoubleArrayTrie():
+		_words(0),
+		_searchFrom(1)
+		{
+			reserveUnits(1);
+			use(ROOT, ROOT);
+		}
+
+		/** Constructor, freezes the words of a tree
+		 * @param[in] tree a TreeString, or any tree with forEachWord
+		 */
+		template <typename T, typename = EnableTree<T>>
+		explicit DoubleArrayTrie(const T &tree):
+		DoubleArrayTrie()
+		{
+			// words come in increasing order
+			vector<pair<string,int>> words;
+			tree.forEachWord([&words](string_view word, int frequency){
+				words.push_back(pair<string,int>(string(word), frequency));
+			});
+			_words = words.size();
+			build(words, 0, words.size(), 0, ROOT);
+			// the last units are never used
+			size_t used = _units.size();
+			while(ROOT+1 < used and -1 == _units[used-1].check) --used;
+			_units.resize(used);
+			_frequencies.resize(used);
+			_firstChild.resize(used);
+			_nextSibling.resize(used);
+			vector<uint32_t>().swap(_skip);
+		}
+
+		/** Constructor, reads a trie written by save
+		 * @param[in] path path of the file
+		 * @exception TreeStringException threw if the file is missing, truncated or corrupted
+		 */
+		explicit DoubleArrayTrie(const string &path):
+		_words(0),
+		_searchFrom(0)
+		{
+			std::ifstream file(path, std::ios::in | std::ios::binary);
+			if(not file) throw TreeStringException("Trie file cannot be opened!");
+			DoubleArrayHeader header;
+			if(not file.read(reinterpret_cast<char*>(&header), sizeof(header))){
+				throw TreeStringException("Trie file is truncated!");
+			}
+			if(0 != std::memcmp(header.magic, "GLOSSYDA", 8)){
+				throw TreeStringException("Not a trie file!");
+			}
+			if(DATRIEVERSION != header.version){
+				throw TreeStringException("Trie file has another version!");
+			}
+			if(0 == header.units){
+				throw TreeStringException("Trie file is corrupted!");
+			}
+			_units.resize(header.units);
+			_frequencies.resize(header.units);
+			_firstChild.resize(header.units);
+			_nextSibling.resize(header.units);
+			file.read(reinterpret_cast<char*>(_units.data()), header.units*sizeof(Unit));
+			file.read(reinterpret_cast<char*>(_frequencies.data()), header.units*sizeof(int));
+			file.read(reinterpret_cast<char*>(_firstChild.data()), header.units*sizeof(uint16_t));
+			file.read(reinterpret_cast<char*>(_nextSibling.data()), header.units*sizeof(uint16_t));
+			if(not file) throw TreeStringException("Trie file is truncated!");
+			if(header.checksum != checksum()) throw TreeStringException("Trie file is corrupted!");
+			// a corrupted base would make child read out of the arrays
+			for(uint32_t s = 0; s<header.units; ++s){
+				if(0 > _units[s].base or header.units < (uint32_t)_units[s].base){
+					throw TreeStringException("Trie file is corrupted!");
+				}
+				// children are linked by increasing codes to states whose parent
+				// is s, so visitFrom stays in the arrays and never loops
+				uint32_t previous = 0;
+				uint32_t c = _firstChild[s];
+				while(0 != c){
+					uint32_t next = (uint32_t)_units[s].base + c;
+					if(c <= previous or 256 < c or header.units <= next or (int32_t)s != _units[next].check){
+						throw TreeStringException("Trie file is corrupted!");
+					}
+					previous = c;
+					c = _nextSibling[next];
+				}
+			}
+			_words = header.words;
+		}
+
+		/** Hashcode of the arrays, to check a file
+		 * @param[out] checksum wyhash of the arrays
+		 */
+		uint64_t checksum() const {
+			uint64_t hash = wyhash(_units.data(), _units.size()*sizeof(Unit), 0);
+			hash = wyhash(_frequencies.data(), _frequencies.size()*sizeof(int), hash);
+			hash = wyhash(_firstChild.data(), _firstChild.size()*sizeof(uint16_t), hash);
+			return wyhash(_nextSibling.data(), _nextSibling.size()*sizeof(uint16_t), hash);
+		}
+
+		/** Write the trie into a file, read back by the path constructor
+		 * @param[in] path path of the file, replaced if it exists
+		 * @exception TreeStringException threw if the file cannot be written
+		 */
+		void save(const string &path) const {
+			DoubleArrayHeader header;
+			std::memcpy(header.magic, "GLOSSYDA", 8);
+			header.version = DATRIEVERSION;
+			header.units = (uint32_t)_units.size();
+			header.words = _words;
+			header.checksum = checksum();
+			std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(_units.data()), _units.size()*sizeof(Unit));
+			file.write(reinterpret_cast<const char*>(_frequencies.data()), _frequencies.size()*sizeof(int));
+			file.write(reinterpret_cast<const char*>(_firstChild.data()), _firstChild.size()*sizeof(uint16_t));
+			file.write(reinterpret_cast<const char*>(_nextSibling.data()), _nextSibling.size()*sizeof(uint16_t));
+			file.close();
+			if(not file) throw TreeStringException("Trie file cannot be written!");
+		}
+
+		/** Number of words
+		 * @param[out] count number of different words
+		 */
+		size_t size() const { return _words; }
+
+		/** Number of states, used or not
+		 * @param[out] count number of units of the arrays
+		 */
+		size_t unitCount() const { return _units.size(); }
+
+		/** Is a word in the trie ?
+		 * @param[in] word the word to look for
+		 * @param[out] bool true if the word is in the trie, else false
+		 */
+		bool contains(string_view word) const {
+			return 0 < frequency(word);
+		}
+
+		/** Frequency of a word
+		 * @param[in] word the word to look for
+		 * @param[out] frequency frequency of the word, 0 if absent
+		 */
+		int frequency(string_view word) const {
+			uint32_t state;
+			if(word.empty() or not walk(word, state)) return 0;
+			return _frequencies[state];
+		}
+
+		/** Call a function on every word starting with a prefix, in
+		 * increasing order of their letters as unsigned chars
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[in] visit function called with each word, as a string_view
+		 * valid during the call only, and its frequency
+		 */
+		template <typename F>
+		void forEachWithPrefix(string_view prefix, F visit) const {
+			uint32_t state;
+			if(not walk(prefix, state)) return;
+			string word(prefix);
+			visitFrom(state, word, visit);
+		}
+
+		/** Get the words starting with a prefix and their frequencies
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[in] words list where the pairs word, frequency are added
+		 */
+		void getWordsWithPrefix(string_view prefix, forward_list<pair<string,int>> &words) const {
+			forEachWithPrefix(prefix, [&words](string_view word, int frequency){
+				words.push_front(pair<string,int>(string(word), frequency));
+			});
+		}
+
+		/** The most frequent words starting with a prefix
+		 * @param[in] k number of words wanted
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[out] words at most k pairs word, frequency, the most frequent first
+		 */
+		vector<pair<string,int>> top(size_t k, string_view prefix = string_view()) const {
+			// the least frequent of the best words found so far is on top
+			auto better = [](const pair<string,int> &a, const pair<string,int> &b){
+				return a.second > b.second or (a.second == b.second and a.first < b.first);
+			};
+			std::priority_queue<pair<string,int>, vector<pair<string,int>>, decltype(better)> best(better);
+			if(0 < k){
+				forEachWithPrefix(prefix, [&best, &better, k](string_view word, int frequency){
+					if(best.size() < k){
+						best.push(pair<string,int>(string(word), frequency));
+					}
+					else if(frequency > best.top().second){
+						best.pop();
+						best.push(pair<string,int>(string(word), frequency));
+					}
+				});
+			}
+			vector<pair<string,int>> words;
+			while(not best.empty()){
+				words.push_back(best.top());
+				best.pop();
+			}
+			std::reverse(words.begin(), words.end());
+			return words;
+		}
+};
+
+#endif // DOUBLEARRAYTRIE_HPP
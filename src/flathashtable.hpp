@@ -0,0 +1,861 @@
+/**
+ * @file flathashtable.hpp
+ *
+ * @section desc File description
+ *
+ * data structure to store pairs in a single array of slots (open addressing)
+ * a hashcode is compute with k to evaluate the suitable group of slots, then
+ * a one-byte tag per slot is compared for a whole group at once
+ *
+ * the hash function is a template parameter, see hashers.hpp
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef FLATHASHTABLE_HPP
+#define FLATHASHTABLE_HPP
+
+// included files section
+#include <new>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <forward_list>
+#include "hashtable.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/// macro to define the number of control tags compared at once
+#ifndef GROUPWIDTH
+#if defined(__AVX2__)
+#define GROUPWIDTH 32
+#elif defined(__SSE2__)
+#define GROUPWIDTH 16
+#else
+#define GROUPWIDTH 8
+#endif
+#endif
+
+using std::string;
+using std::pair;
+using std::forward_list;
+
+/** \brief A group of GROUPWIDTH control tags.
+ *
+ * A control tag is EMPTY, DELETED, or the 7 low bits of the hash of the key
+ * stored in the slot. Matching returns a bit mask, bit i standing for the
+ * i-th slot of the group.
+*/
+class ControlGroup {
+	public:
+		static const int8_t EMPTY = -128; /** tag of a never used slot */
+		static const int8_t DELETED = -2; /** tag of a removed slot */
+
+	private:
+		const int8_t* _tags; /** first tag of the group */
+
+	public:
+		/** Constructor
+		 * @param[in] tags adress of the first tag of the group
+		*/
+		explicit ControlGroup(const int8_t* tags):
+		_tags(tags)
+		{}
+
+		/** Which slots are tagged with tag ?
+		 * @param[in] tag the tag to look for
+		 * @param[out] mask bit mask of the matching slots
+		*/
+		uint32_t match(int8_t tag) const {
+#if GROUPWIDTH == 32 && defined(__AVX2__)
+			__m256i tags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_tags));
+			return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(tags, _mm256_set1_epi8(tag)));
+#elif GROUPWIDTH == 16 && defined(__SSE2__)
+			__m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_tags));
+			return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(tag)));
+#else
+			uint32_t mask = 0;
+			for(int i = 0; i<GROUPWIDTH; ++i){
+				if(tag == _tags[i]) mask |= (uint32_t)1 << i;
+			}
+			return mask;
+#endif
+		}
+
+		/** Which slots are not holding a pair ?
+		 * @param[out] mask bit mask of the empty and deleted slots
+		*/
+		uint32_t matchFree() const {
+#if GROUPWIDTH == 32 && defined(__AVX2__)
+			// free tags are the only negative ones
+			return (uint32_t)_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(_tags)));
+#elif GROUPWIDTH == 16 && defined(__SSE2__)
+			return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_tags)));
+#else
+			uint32_t mask = 0;
+			for(int i = 0; i<GROUPWIDTH; ++i){
+				if(0 > _tags[i]) mask |= (uint32_t)1 << i;
+			}
+			return mask;
+#endif
+		}
+};
+
+/** \brief Maps a key to a value, storing pairs in a single array.
+ *
+ * Same use as Hashtable, but no alveole is allocated: pairs are stored in
+ * one array of slots divided in groups of GROUPWIDTH slots, with one control
+ * tag per slot. A lookup compares the tags of a whole group at once and
+ * compares keys only where the tag matches.
+ * Keys are hashed by a hasher H (see hashers.hpp).
+*/
+template <typename K, typename V, typename H = DefaultHasher<K>>
+class FlatHashtable {
+
+	private:
+		int8_t* _tags; /** control tags, one for each slot */
+		pair<K,V>* _slots; /** array of slots */
+		unsigned _capacity; /** number of slots, a power of two multiple of GROUPWIDTH */
+		unsigned _size; /** number of pairs stored */
+		unsigned _deleted; /** number of slots tagged DELETED */
+		H _hasher; /** computes hashcodes of keys */
+#ifdef HASHTABLE_STATS
+		TableCounters _counters; /** what the table did, see tablestats.hpp */
+#endif
+
+		/** Tag stored for a hashcode
+		 * @param[in] hash hashcode of a key
+		 * @param[out] tag the 7 low bits of hash
+		*/
+		static int8_t tagOf(size_t hash){ return (int8_t)(hash & 0x7F); }
+
+		/** Allocate empty arrays of slots
+		 * @param[in] capacity number of slots
+		*/
+		void allocate(unsigned capacity){
+			TABLECOUNT(allocations, 1);
+			_capacity = capacity;
+			_tags = new int8_t[capacity];
+			for(unsigned i = 0; i<capacity; ++i){
+				_tags[i] = ControlGroup::EMPTY;
+			}
+			_slots = static_cast<pair<K,V>*>(::operator new(capacity*sizeof(pair<K,V>)));
+		}
+
+		/** Destroy the pairs and free the arrays
+		*/
+		void release(){
+			for(unsigned i = 0; i<_capacity; ++i){
+				if(0 <= _tags[i]) _slots[i].~pair<K,V>();
+			}
+			delete[] _tags;
+			::operator delete(_slots);
+		}
+
+		/** Copy the slots of another table, into arrays of the same capacity
+		 * so every pair stays in its slot
+		 * @param[in] other table to copy
+		*/
+		void copySlots(const FlatHashtable<K,V,H> &other){
+			allocate(other._capacity);
+			for(unsigned i = 0; i<_capacity; ++i){
+				_tags[i] = other._tags[i];
+				if(0 <= _tags[i]) new (_slots + i) pair<K,V>(other._slots[i]);
+			}
+			_size = other._size;
+			_deleted = other._deleted;
+		}
+
+		/** Find the slot storing a key
+		 * Groups are probed one after the other with a growing step
+		 * until a group with an empty slot.
+		 * @param[in] key key to find
+		 * @param[in] hash hashcode of key
+		 * @param[out] index slot of key, _capacity if key is not here
+		*/
+		template <typename Q>
+		unsigned find(const Q &key, size_t hash){
+			unsigned groups = _capacity/GROUPWIDTH;
+			unsigned group = (hash >> 7) & (groups-1);
+			int8_t tag = tagOf(hash);
+			for(unsigned step = 1; step <= groups; ++step){
+				ControlGroup control(_tags + group*GROUPWIDTH);
+				uint32_t mask = control.match(tag);
+				while(0 != mask){
+					unsigned index = group*GROUPWIDTH + __builtin_ctz(mask);
+					TABLECOUNT(compares, 1);
+					if(key == _slots[index].first){
+						TABLECOUNT(hits, 1);
+						return index;
+					}
+					mask &= mask-1;
+				}
+				if(0 != control.match(ControlGroup::EMPTY)) break;
+				group = (group + step) & (groups-1);
+			}
+			TABLECOUNT(misses, 1);
+			return _capacity;
+		}
+
+		/** First free slot on the probe sequence of a hashcode
+		 * @param[in] hash hashcode of a key
+		 * @param[out] index a free slot
+		*/
+		unsigned findFree(size_t hash){
+			unsigned groups = _capacity/GROUPWIDTH;
+			unsigned group = (hash >> 7) & (groups-1);
+			uint32_t mask = ControlGroup(_tags + group*GROUPWIDTH).matchFree();
+			for(unsigned step = 1; 0 == mask; ++step){
+				group = (group + step) & (groups-1);
+				mask = ControlGroup(_tags + group*GROUPWIDTH).matchFree();
+			}
+			return group*GROUPWIDTH + __builtin_ctz(mask);
+		}
+
+		/** Move every pair into new arrays of slots
+		 * @param[in] capacity number of slots of the new arrays
+		*/
+		void rehash(unsigned capacity){
+			int8_t* tags = _tags;
+			pair<K,V>* slots = _slots;
+			unsigned oldCapacity = _capacity;
+			allocate(capacity);
+			_deleted = 0;
+			for(unsigned i = 0; i<oldCapacity; ++i){
+				if(0 <= tags[i]){
+					size_t hash = _hasher(slots[i].first);
+					unsigned index = findFree(hash);
+					_tags[index] = tagOf(hash);
+					new (_slots + index) pair<K,V>(std::move(slots[i]));
+					slots[i].~pair<K,V>();
+				}
+			}
+			delete[] tags;
+			::operator delete(slots);
+		}
+
+		/** Value maped to a key
+		 * @param[in] key a key in the hashtable
+		 * @param[out] value value associated with the key
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		template <typename Q>
+		const V& valueOf(const Q &key){
+			unsigned index = find(key, _hasher(key));
+			if(_capacity == index) throw HashtableException("Key not found!");
+			return _slots[index].second;
+		}
+
+		/** Find the slot storing a key, or map the key to a value
+		 * The key is hashed only once.
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair if key is not here yet
+		 * @param[in] inserted set to true if the pair was added, else false
+		 * @param[out] index slot storing key
+		*/
+		template <typename Q>
+		unsigned findOrInsert(const Q &key, const V &value, bool &inserted){
+			return findOrInsert(key, _hasher(key), value, inserted);
+		}
+
+		/** Find the slot storing a key already hashed, or map the key to a value
+		 * @param[in] key key of the pair
+		 * @param[in] hash hashcode of key
+		 * @param[in] value value of the pair if key is not here yet
+		 * @param[in] inserted set to true if the pair was added, else false
+		 * @param[out] index slot storing key
+		*/
+		template <typename Q>
+		unsigned findOrInsert(const Q &key, size_t hash, const V &value, bool &inserted){
+			unsigned index = find(key, hash);
+			inserted = (_capacity == index);
+			if(inserted){
+				// keep the table at most 7/8 full, deleted slots included
+				if(_size + _deleted + 1 > _capacity - _capacity/8){
+					rehash(_size + 1 > _capacity/2 ? 2*_capacity : _capacity);
+				}
+				index = findFree(hash);
+				if(ControlGroup::DELETED == _tags[index]) --_deleted;
+				_tags[index] = tagOf(hash);
+				new (_slots + index) pair<K,V>(K(key), value);
+				++_size;
+			}
+			return index;
+		}
+
+		/** Hash a chunk of keys and prefetch the first group of slots
+		 * of each key, tags and pairs, so the cache misses of the keys
+		 * overlap instead of waiting for each other.
+		 * @param[in] keys keys of the chunk
+		 * @param[in] count number of keys, at most BATCHSIZE
+		 * @param[in] hashes set to the hashcodes of the keys
+		*/
+		template <typename Q>
+		void prefetchBatch(const Q* keys, size_t count, size_t* hashes){
+			unsigned groups = _capacity/GROUPWIDTH;
+			for(size_t i = 0; i<count; ++i){
+				hashes[i] = _hasher(keys[i]);
+				unsigned first = ((hashes[i] >> 7) & (groups-1))*GROUPWIDTH;
+				__builtin_prefetch(_tags + first);
+				__builtin_prefetch(_slots + first);
+			}
+		}
+
+		/** Map a key to a value, or update the value maped to the key
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair
+		*/
+		template <typename Q>
+		void insert(const Q &key, const V &value){
+			bool inserted;
+			unsigned index = findOrInsert(key, value, inserted);
+			if(not inserted){
+				_slots[index].second = value;
+			}
+		}
+
+		/** Remove a key and its value
+		 * @param[in] key Key of the pair to delete
+		 * @exception HashtableException threw if table does not contain key
+		*/
+		template <typename Q>
+		void erase(const Q &key){
+			unsigned index = find(key, _hasher(key));
+			if(_capacity == index) throw HashtableException("Key is not here!");
+			_slots[index].~pair<K,V>();
+			// a lookup stops at a group with an empty slot, so no key was
+			// put after this group and the slot can be empty again
+			if(0 != ControlGroup(_tags + index/GROUPWIDTH*GROUPWIDTH).match(ControlGroup::EMPTY)){
+				_tags[index] = ControlGroup::EMPTY;
+			}
+			else {
+				_tags[index] = ControlGroup::DELETED;
+				++_deleted;
+			}
+			--_size;
+		}
+
+	public:
+		/** \brief Forward iterator over the pairs of a FlatHashtable.
+		 *
+		 * Yields references to the pairs stored into the slots, nothing is
+		 * copied. Pairs are read only since their keys place them in the
+		 * table, use value() to update a value. Putting keys invalidates
+		 * the iterators.
+		*/
+		template <bool Const>
+		class Iterator {
+			friend class FlatHashtable<K,V,H>;
+			template <bool> friend class Iterator;
+
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef pair<K,V> value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const value_type* pointer;
+				typedef const value_type& reference;
+
+			private:
+				const FlatHashtable<K,V,H>* _owner; /** browsed hashtable */
+				unsigned _index; /** current slot, _owner->_capacity at the end */
+
+				/** Constructor, used by begin() and end()
+				 * @param[in] owner browsed hashtable
+				 * @param[in] index first slot to look in
+				*/
+				Iterator(const FlatHashtable<K,V,H>* owner, unsigned index):
+				_owner(owner),
+				_index(index)
+				{
+					findSlot();
+				}
+
+				/** Go to the first slot holding a pair, starting from _index
+				*/
+				void findSlot(){
+					while(_index < _owner->_capacity and 0 > _owner->_tags[_index]){
+						++_index;
+					}
+				}
+
+			public:
+				/** Empty constructor
+				*/
+				Iterator():
+				_owner(nullptr),
+				_index(0)
+				{}
+
+				/** Conversion constructor, from iterator to const_iterator
+				 * @param[in] other iterator to convert
+				*/
+				Iterator(const Iterator<false> &other):
+				_owner(other._owner),
+				_index(other._index)
+				{}
+
+				/** The pair the iterator is on
+				 * @param[out] pair reference to the stored pair
+				*/
+				reference operator*() const { return _owner->_slots[_index]; }
+
+				/** Access to the members of the pair the iterator is on
+				 * @param[out] ptr adress of the stored pair
+				*/
+				pointer operator->() const { return _owner->_slots + _index; }
+
+				/** The value of the pair the iterator is on, to update it in place
+				 * @param[out] value reference to the stored value
+				*/
+				typename std::conditional<Const, const V&, V&>::type value() const {
+					return const_cast<FlatHashtable<K,V,H>*>(_owner)->_slots[_index].second;
+				}
+
+				/** Go to the next pair
+				 * @param[out] iterator this iterator
+				*/
+				Iterator<Const>& operator++(){
+					++_index;
+					findSlot();
+					return (*this);
+				}
+
+				/** Go to the next pair
+				 * @param[out] iterator a copy of the iterator before moving
+				*/
+				Iterator<Const> operator++(int){
+					Iterator<Const> before = (*this);
+					++(*this);
+					return before;
+				}
+
+				/** equality operator
+				 * @param[in] rhs iterator to compare
+				 * @param[out] bool true if both iterators are on the same slot
+				*/
+				template <bool C>
+				bool operator==(const Iterator<C> &rhs) const { return _index == rhs._index; }
+
+				/** inequality operator
+				 * @param[in] rhs iterator to compare
+				 * @param[out] bool true if iterators are not on the same slot
+				*/
+				template <bool C>
+				bool operator!=(const Iterator<C> &rhs) const { return _index != rhs._index; }
+		};
+
+		/// iterator over pairs, values can be updated with value()
+		typedef Iterator<false> iterator;
+		/// iterator over pairs, read only
+		typedef Iterator<true> const_iterator;
+		/// type of the keys
+		typedef K key_type;
+		/// type of the values
+		typedef V mapped_type;
+
+		/** Simple constructor
+		*/
+		FlatHashtable():
+		_size(0),
+		_deleted(0)
+		{
+			allocate(GROUPWIDTH);
+		}
+
+		/** Capacity constructor
+		 * @param[in] capacity number of pairs to make room for
+		 * @param[in] hasher hash function of the table, e.g. a seeded WyHasher
+		*/
+		explicit FlatHashtable(unsigned capacity, const H &hasher = H()):
+		_size(0),
+		_deleted(0),
+		_hasher(hasher)
+		{
+			unsigned slots = GROUPWIDTH;
+			// keep the table at most 7/8 full
+			while(slots - slots/8 < capacity) slots *= 2;
+			allocate(slots);
+		}
+
+		/** Copy constructor
+		 * @param[in] other table to copy, pairs are copied too
+		*/
+		FlatHashtable(const FlatHashtable<K,V,H> &other):
+		_hasher(other._hasher)
+		{
+			copySlots(other);
+		}
+
+		/** Destructor
+		*/
+		~FlatHashtable(){
+			release();
+		}
+
+		/** assignment operator overload
+		 * @param[in] other table to copy, pairs are copied too
+		 * @param[out] table assigned table
+		*/
+		FlatHashtable<K,V,H>& operator=(const FlatHashtable<K,V,H> &other){
+			// prevent objet copying itself
+			if(this != &other){
+				release();
+				// tags come from the hashcodes, they must come from the same hasher
+				_hasher = other._hasher;
+				copySlots(other);
+			}
+			return (*this); // allow a = b = c
+		}
+
+		/** Do table contains key ?
+		 * @param[in] key key to find
+		 * @param[out] bool True if the key is here, else false
+		*/
+		bool contains(const K &key){
+			return _capacity != find(key, _hasher(key));
+		}
+
+		/** Do table contains key ? Lookup without building a K.
+		 * @param[in] key key to find, e.g. a string_view for string keys
+		 * @param[out] bool True if the key is here, else false
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		bool contains(const Q &key){
+			return _capacity != find(key, _hasher(key));
+		}
+
+		/** Return the value maped to the specified key
+		 * @param[in] key a key in the hashtable
+		 * @param[out] value value associated with the key
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		const V& get(const K &key){
+			return valueOf(key);
+		}
+
+		/** Return the value maped to the specified key, without building a K.
+		 * @param[in] key a key in the hashtable, e.g. a string_view for string keys
+		 * @param[out] value value associated with the key
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		const V& get(const Q &key){
+			return valueOf(key);
+		}
+
+		/** Tests if this hashtable maps no keys to values.
+		 * @param[out] bool true if no elements in the hashtable, else false;
+		*/
+		bool isEmpty(){
+			return 0 == _size;
+		}
+
+		/** Number of pairs stored in the hashtable
+		 * @param[out] size number of keys
+		*/
+		unsigned size(){ return _size; }
+
+		/** Number of slots of the hashtable
+		 * @param[out] capacity number of slots
+		*/
+		unsigned capacity(){ return _capacity; }
+
+		/** How the pairs are spread over the groups of slots, and the
+		 * counters of the table if HASHTABLE_STATS is defined
+		 * Every key is hashed again to know where its probe sequence starts.
+		 * @param[out] stats statistics of the table
+		*/
+		TableStats stats() const {
+			TableStats stats;
+			unsigned groups = _capacity/GROUPWIDTH;
+			unsigned long probes = 0;
+			for(unsigned group = 0; group<groups; ++group){
+				unsigned count = 0;
+				for(unsigned i = group*GROUPWIDTH; i<(group+1)*GROUPWIDTH; ++i){
+					if(0 <= _tags[i]){
+						++count;
+						// follow the probe sequence of the key up to the group storing it
+						unsigned probe = (_hasher(_slots[i].first) >> 7) & (groups-1);
+						unsigned length = 1;
+						while(probe != group){
+							probe = (probe + length) & (groups-1);
+							++length;
+						}
+						probes += length;
+						if(stats.maxProbe < length) stats.maxProbe = length;
+					}
+				}
+				stats.addBucket(count);
+			}
+			stats.size = _size;
+			stats.loadFactor = (float)_size/_capacity;
+			stats.meanProbe = 0 < _size ? (float)probes/_size : 0;
+#ifdef HASHTABLE_STATS
+			stats.counters = _counters;
+#endif
+			return stats;
+		}
+
+		/** Map the specified key to the specified value in this hashtable.
+		 * or update the maped value to the key
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair
+		*/
+		void put(const K &key, const V &value){
+			insert(key, value);
+		}
+
+		/** Map the specified key to the specified value in this hashtable.
+		 * or update the maped value to the key
+		 * A K is built from key only if key is not in the table yet.
+		 * @param[in] key key of the pair, e.g. a string_view for string keys
+		 * @param[in] value value of the pair
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		void put(const Q &key, const V &value){
+			insert(key, value);
+		}
+
+		/** Get the value maped to a key, mapping the key to value first if
+		 * the key is not in the table. The key is looked up only once.
+		 * The reference is valid until the next pair is added.
+		 * @param[in] key key of the pair
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[out] value reference to the value maped to key, to update it
+		*/
+		V& upsert(const K &key, const V &value){
+			bool inserted;
+			// the slots may move while the key is put, find the index first
+			unsigned index = findOrInsert(key, value, inserted);
+			return _slots[index].second;
+		}
+
+		/** Get the value maped to a key, mapping the key to value first if
+		 * the key is not in the table. The key is looked up only once.
+		 * The reference is valid until the next pair is added.
+		 * @param[in] key key of the pair, e.g. a string_view for string keys
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[out] value reference to the value maped to key, to update it
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		V& upsert(const Q &key, const V &value){
+			bool inserted;
+			// the slots may move while the key is put, find the index first
+			unsigned index = findOrInsert(key, value, inserted);
+			return _slots[index].second;
+		}
+
+		/** Update the value maped to a key with a function, or map the key
+		 * to value if the key is not in the table. The key is looked up only once.
+		 * @param[in] key key of the pair
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[in] update function called with a reference to the value maped to key, if key was here
+		 * @param[out] value reference to the value maped to key
+		*/
+		template <typename F>
+		V& upsert(const K &key, const V &value, F update){
+			bool inserted;
+			unsigned index = findOrInsert(key, value, inserted);
+			V &mapped = _slots[index].second;
+			if(not inserted) update(mapped);
+			return mapped;
+		}
+
+		/** Update the value maped to a key with a function, or map the key
+		 * to value if the key is not in the table. The key is looked up only once.
+		 * @param[in] key key of the pair, e.g. a string_view for string keys
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[in] update function called with a reference to the value maped to key, if key was here
+		 * @param[out] value reference to the value maped to key
+		*/
+		template <typename Q, typename F, typename = EnableLookup<Q,K>>
+		V& upsert(const Q &key, const V &value, F update){
+			bool inserted;
+			unsigned index = findOrInsert(key, value, inserted);
+			V &mapped = _slots[index].second;
+			if(not inserted) update(mapped);
+			return mapped;
+		}
+
+		/** Map keys to values, as put does for each pair
+		 * Keys are hashed and their slots prefetched BATCHSIZE at a time
+		 * before being put.
+		 * @param[in] keys array of keys, K or any type FlatHashtable looks up
+		 * @param[in] values array of values, values[i] is maped to keys[i]
+		 * @param[in] count number of pairs
+		*/
+		template <typename Q>
+		void putBatch(const Q* keys, const V* values, size_t count){
+			size_t hashes[BATCHSIZE];
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchBatch(keys + start, n, hashes);
+				for(size_t i = 0; i<n; ++i){
+					bool inserted;
+					unsigned index = findOrInsert(keys[start+i], hashes[i], values[start+i], inserted);
+					if(not inserted) _slots[index].second = values[start+i];
+				}
+			}
+		}
+
+		/** Find the values maped to keys
+		 * Keys are hashed and their slots prefetched BATCHSIZE at a time
+		 * before being looked up. Putting or removing keys invalidates the
+		 * adresses of the values.
+		 * @param[in] keys array of keys, K or any type FlatHashtable looks up
+		 * @param[in] count number of keys
+		 * @param[in] values array set to the adresses of the values, nullptr if a key is not here
+		 * @param[out] found number of keys found
+		*/
+		template <typename Q>
+		size_t getBatch(const Q* keys, size_t count, const V** values){
+			size_t hashes[BATCHSIZE];
+			size_t found = 0;
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchBatch(keys + start, n, hashes);
+				for(size_t i = 0; i<n; ++i){
+					unsigned index = find(keys[start+i], hashes[i]);
+					values[start+i] = _capacity == index ? nullptr : &_slots[index].second;
+					if(_capacity != index) ++found;
+				}
+			}
+			return found;
+		}
+
+		/** Update the values maped to keys with a function, or map the keys
+		 * not in the table to value, as upsert does for each key
+		 * Keys are hashed and their slots prefetched BATCHSIZE at a time
+		 * before being updated.
+		 * @param[in] keys array of keys, K or any type FlatHashtable looks up
+		 * @param[in] count number of keys
+		 * @param[in] value value maped to keys not here yet
+		 * @param[in] update function called with a reference to the value maped to each key already here
+		 * @param[out] inserted array set to true for each key maped to value, not here before, nullptr if unused
+		*/
+		template <typename Q, typename F>
+		void upsertBatch(const Q* keys, size_t count, const V &value, F update, bool* inserted = nullptr){
+			size_t hashes[BATCHSIZE];
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchBatch(keys + start, n, hashes);
+				for(size_t i = 0; i<n; ++i){
+					bool isNew;
+					unsigned index = findOrInsert(keys[start+i], hashes[i], value, isNew);
+					if(not isNew) update(_slots[index].second);
+					if(nullptr != inserted) inserted[start+i] = isNew;
+				}
+			}
+		}
+
+		/** Remove the key (and its corresponding value) from this hashtable.
+		 * @param[in] key Key of the pair to delete
+		 * @exception HashtableException threw if table does not contain key
+		*/
+		void remove(const K &key){
+			erase(key);
+		}
+
+		/** Remove the key (and its corresponding value) from this hashtable.
+		 * @param[in] key Key of the pair to delete, e.g. a string_view for string keys
+		 * @exception HashtableException threw if table does not contain key
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		void remove(const Q &key){
+			erase(key);
+		}
+
+		/** Return a description of the hashtable, enclosed in braces as
+		 * well as {key, value}.
+		 * @param[out] desc a string representation of this hashtable.
+		 */
+		string toString(){
+			string desc = "[";
+			for(unsigned i = 0; i<_capacity; ++i){
+				if(0 <= _tags[i]){
+					desc += (desc.size()<2 ? "{" : ", {") + _slots[i].first + ", " + _slots[i].second + "}";
+				}
+			}
+			return desc + "]";
+		}
+
+		/** Get a list of all kay and their value in pairs
+		 * @param[in] pairs list to add pairs in
+		 */
+		void getPairs(forward_list<pair<string, int>> &pairs){
+			for(unsigned i = 0; i<_capacity; ++i){
+				if(0 <= _tags[i]){
+					pairs.push_front(pair<string, int>(_slots[i].first, _slots[i].second));
+				}
+			}
+		}
+
+		/** Iterator on the first pair
+		 * @param[out] iterator iterator on the first pair, end() if the table is empty
+		*/
+		iterator begin(){ return iterator(this, 0); }
+
+		/** Iterator after the last pair
+		 * @param[out] iterator iterator after the last pair
+		*/
+		iterator end(){ return iterator(this, _capacity); }
+
+		/** Iterator on the first pair, read only
+		 * @param[out] iterator iterator on the first pair, end() if the table is empty
+		*/
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		/** Iterator after the last pair, read only
+		 * @param[out] iterator iterator after the last pair
+		*/
+		const_iterator end() const { return const_iterator(this, _capacity); }
+
+		/** Iterator on the first pair, read only
+		 * @param[out] iterator iterator on the first pair, end() if the table is empty
+		*/
+		const_iterator cbegin() const { return begin(); }
+
+		/** Iterator after the last pair, read only
+		 * @param[out] iterator iterator after the last pair
+		*/
+		const_iterator cend() const { return end(); }
+
+		/** Call a function on every pair
+		 * @param[in] visit function called with a const reference to each pair
+		*/
+		template <typename F>
+		void forEach(F visit) const {
+			for(const_iterator it = begin(); it != end(); ++it){
+				visit(*it);
+			}
+		}
+};
+
+#endif // FLATHASHTABLE_HPP
@@ -0,0 +1,240 @@
+/**
+ * @file hashers.hpp
+ *
+ * @section desc File description
+ *
+ * hash functions given to hashtables as a template parameter
+ *
+ * A hasher is a class with a const operator() taking a key and returning
+ * a size_t hashcode. Hashtables choose buckets with the low bits of the
+ * hashcode (power of two masking), so every bit must depend on the key.
+ * To look keys up with another type (e.g. std::string_view for string keys),
+ * the hasher must accept this type too and give the same hashcode for
+ * equal keys.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef HASHERS_HPP
+#define HASHERS_HPP
+
+// included files section
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+/**
+ * Mix the bits of a hashcode, so that every bit of the result depends on
+ * every bit of hash (finalizer of MurmurHash3)
+ * @param[in] hash a hashcode, maybe with weak low bits (e.g. std::hash of an integer)
+ * @param[out] mixed the mixed hashcode
+*/
+inline uint64_t mixHash(uint64_t hash){
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/**
+ * Multiply two 64 bits integers into a 128 bits product
+ * @param[in] a first factor, set to the low 64 bits of the product
+ * @param[in] b second factor, set to the high 64 bits of the product
+*/
+inline void multiply128(uint64_t &a, uint64_t &b){
+#ifdef __SIZEOF_INT128__
+	__uint128_t product = (__uint128_t)a*b;
+	a = (uint64_t)product;
+	b = (uint64_t)(product >> 64);
+#else
+	uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+	uint64_t rh = ha*hb, rm0 = ha*lb, rm1 = hb*la, rl = la*lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t carry = t < rl;
+	a = t + (rm1 << 32);
+	carry += a < t;
+	b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+/**
+ * Multiply two 64 bits integers and fold the 128 bits product
+ * @param[in] a first factor
+ * @param[in] b second factor
+ * @param[out] folded low 64 bits of a*b xor high 64 bits of a*b
+*/
+inline uint64_t foldedMultiply(uint64_t a, uint64_t b){
+	multiply128(a, b);
+	return a ^ b;
+}
+
+/**
+ * Read 8 bytes as an integer, whatever their alignment
+ * @param[in] p adress of the bytes
+ * @param[out] value the bytes as a little or big endian integer, as the processor
+*/
+inline uint64_t read64(const uint8_t* p){
+	uint64_t value;
+	std::memcpy(&value, p, 8);
+	return value;
+}
+
+/**
+ * Read 4 bytes as an integer, whatever their alignment
+ * @param[in] p adress of the bytes
+ * @param[out] value the bytes as an integer
+*/
+inline uint64_t read32(const uint8_t* p){
+	uint32_t value;
+	std::memcpy(&value, p, 4);
+	return value;
+}
+
+/**
+ * Hash bytes with the wyhash algorithm : a few 64 bits multiplications
+ * for each 16 bytes, and no loop for keys up to 16 bytes.
+ * @param[in] data adress of the bytes
+ * @param[in] len number of bytes
+ * @param[in] seed seed of the hash function
+ * @param[out] hashcode hashcode of the bytes
+*/
+inline uint64_t wyhash(const void* data, size_t len, uint64_t seed){
+	static const uint64_t secret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+	                                   0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	uint64_t a, b;
+	seed ^= foldedMultiply(seed ^ secret[0], secret[1]);
+	if(16 >= len){
+		if(4 <= len){
+			a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+			b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if(0 < len){
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		size_t i = len;
+		if(48 < i){
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = foldedMultiply(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+				see1 = foldedMultiply(read64(p + 16) ^ secret[2], read64(p + 24) ^ see1);
+				see2 = foldedMultiply(read64(p + 32) ^ secret[3], read64(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while(48 < i);
+			seed ^= see1 ^ see2;
+		}
+		while(16 < i){
+			seed = foldedMultiply(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = read64(p + i - 16);
+		b = read64(p + i - 8);
+	}
+	a ^= secret[1];
+	b ^= seed;
+	multiply128(a, b);
+	return foldedMultiply(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/** \brief Hashes strings with wyhash.
+ *
+ * Takes anything converted into a std::string_view, so strings can be
+ * looked up with string_views or C strings and get the same hashcodes.
+*/
+class WyHasher {
+	private:
+		uint64_t _seed; /** seed of the hash function */
+
+	public:
+		/** Constructor
+		 * @param[in] seed seed of the hash function, tables hashing with
+		 * different seeds spread the same keys differently
+		*/
+		explicit WyHasher(uint64_t seed = 0x2d358dccaa6c78a5ull):
+		_seed(seed)
+		{}
+
+		/** Hashcode of a string
+		 * @param[in] key the string
+		 * @param[out] hashcode hashcode of key
+		*/
+		size_t operator()(std::string_view key) const {
+			return wyhash(key.data(), key.size(), _seed);
+		}
+};
+
+/** \brief Hashes keys with std::hash, then mixes the bits of the hashcode.
+ *
+ * std::hash of integers is the identity, mixing keeps them from falling in
+ * the same buckets when only a few low bits are used.
+*/
+template <typename K>
+class StdHasher {
+	public:
+		/** Hashcode of a key
+		 * @param[in] key the key
+		 * @param[out] hashcode hashcode of key
+		*/
+		size_t operator()(const K &key) const {
+			return mixHash(std::hash<K>()(key));
+		}
+};
+
+/** \brief Hasher used by hashtables when none is given : StdHasher,
+ * except for strings and string_views which use WyHasher
+*/
+template <typename K>
+class DefaultHasher : public StdHasher<K> {};
+
+/** \brief Strings are hashed by WyHasher
+*/
+template <>
+class DefaultHasher<std::string> : public WyHasher {
+	public:
+		using WyHasher::WyHasher;
+};
+
+/** \brief String views are hashed by WyHasher, as strings
+*/
+template <>
+class DefaultHasher<std::string_view> : public WyHasher {
+	public:
+		using WyHasher::WyHasher;
+};
+
+#endif // HASHERS_HPP
@@ -6,7 +6,7 @@
  * data structure to store pairs in a table
  * a hashcode is compute with k to evaluate the suitable place to store the pair
  *
- * !! WARNING: int hashCode(K key) must be implemented !!
+ * the hash function is a template parameter, see hashers.hpp
  *
  * @section copyright Copyright
  *
@@ -33,7 +33,6 @@
  * $Author$ Benjamin Sientzoff
  * $URL$ http://www.github.com/blasterbug
  *
- * \todo : removing the last element of a alveoles chain makes trouble (seg fault)
 */
 #ifndef HASHTABLE_HPP
 #define HASHTABLE_HPP
@@ -43,16 +42,37 @@
 #define END nullptr
 #endif
 
-/// macro to define size of hash arrays
+/// macro to define size of hash arrays, rounded up to a power of two
 #ifndef ARRAYSIZE
 #define ARRAYSIZE 25
 #endif
 
+/// macro to define the default load factor over which hashtables grow
+#ifndef MAXLOADFACTOR
+#define MAXLOADFACTOR 1.0f
+#endif
+
+/// macro to define how many buckets are moved at each operation while rehashing
+#ifndef REHASHSTEP
+#define REHASHSTEP 4
+#endif
+
+/// macro to define how many keys batch operations hash and prefetch at once
+#ifndef BATCHSIZE
+#define BATCHSIZE 32
+#endif
+
 // included files section
 #include <string>
 #include <cassert>
 #include <utility>
+#include <cstddef>
+#include <iterator>
 #include <forward_list>
+#include <type_traits>
+#include "hashers.hpp"
+#include "tablestats.hpp"
+#include "slaballocator.hpp"
 
 // will desactive cassert
 #define NDEBUG
@@ -62,17 +82,12 @@ using std::pair;
 using std::forward_list;
 
 /**
- * Fonction you must define when you're using Hashable
- * An exemple is given in the sample file
- * @param[in] element element to compute hashcode from
- * @param[out] hashcode the hashcode of element, an unsigned integer
- *
- * template<> unisgned computehash<string>(string element)
- *
- * your implementation of hashcode function
- *
+ * Enable the lookup overloads taking a key of type Q instead of K.
+ * Types implicitly converted into K use the K overloads instead, so
+ * the hasher does not need to accept them.
 */
-template <typename K> unsigned computehash(K element);
+template <typename Q, typename K>
+using EnableLookup = typename std::enable_if<not std::is_convertible<const Q&, const K&>::value>::type;
 
 /**
  * \brief Exception class to manage Hashtable errors
@@ -109,12 +124,11 @@ class HashtableException : std::exception {
  * Alveole class embodies a Hashtable's alveole. An alveole store a pair <k,v>.
  * Alveoles are simply-linked elements.
 */
-// TODO: implement iterator to browse within alveoles very quickly and easely
 template <typename K, typename V>
 class Alveole{
 	private:
-		K _key; /** key of the pair */
-		V _value; /** value of the pair */
+		pair<const K,V> _pair; /** key and value of the pair */
+		size_t _hash; /** hashcode of the key, computed once */
 		Alveole<K,V>* _next; /** next aveole */
 	
 	public:
@@ -123,40 +137,32 @@ class Alveole{
 		 * @param[in] other the alveole to copy
 		*/
 		Alveole(const Alveole<K,V> &other):
-		_key(other._key),
-		_value(other._value)
+		_pair(other._pair),
+		_hash(other._hash)
 		{
 			// if there are elements coming next
 			if(END != other._next){
-				_next = new Alveole(other._next);
+				_next = new Alveole(*other._next);
 			}
 			else {
 				_next = END;
 			}
 		}
 
-		/** Pair constructor
-		 * @param[in] key key of the pair
-		 * @param[in] value value of the pair
-		*/
-		Alveole(K key, V value) :
-		_key(key), _value(value),
-		_next(END)
-		{}
-
 		/** Empty constructor
 		 * create an 'empty' alveole
 		*/
-		Alveole() : _next(END){};
+		Alveole() : _hash(0), _next(END){};
 
 		/** Complex constructor
 		 * @param[in] key key of the pair
 		 * @param[in] value value of the pair
+		 * @param[in] hash hashcode of key
 		 * @param[in] next adresse to the next alveole
 		*/
-		Alveole(K key, V value, Alveole<K,V>* next):
-		_key(key),
-		_value(value),
+		Alveole(const K &key, const V &value, size_t hash, Alveole<K,V>* next):
+		_pair(key, value),
+		_hash(hash),
 		_next(next)
 		{}
 
@@ -171,22 +177,53 @@ class Alveole{
 		/** Get the key of an alveole
 		 * @param[out] key key stored into the alveole
 		*/
-		K getKey(){ return _key; }
+		const K& getKey() const { return _pair.first; }
 
 		/** Get the value stored into an alveole
 		 * @param[out] value value of the alveole
 		*/
-		V getValue(){ return _value; }
+		const V& getValue() const { return _pair.second; }
+
+		/** Get the value stored into an alveole, to update it in place
+		 * @param[out] value value of the alveole
+		*/
+		V& getValue(){ return _pair.second; }
+
+		/** Get the pair stored into an alveole
+		 * @param[out] pair key and value of the alveole
+		*/
+		const pair<const K,V>& getPair() const { return _pair; }
+
+		/** Get the pair stored into an alveole, the value can be updated in place
+		 * @param[out] pair key and value of the alveole
+		*/
+		pair<const K,V>& getPair(){ return _pair; }
+
+		/** Get the hashcode of the key, as computed when the alveole was made
+		 * @param[out] hash hashcode of the key
+		*/
+		size_t getHash() const { return _hash; }
+
+		/** Does the alveole store this key ?
+		 * Hashcodes are compared first, keys only if hashcodes are equal.
+		 * @param[in] key key to compare, of any type comparable with K
+		 * @param[in] hash hashcode of key
+		 * @param[out] bool true if key is stored here, else false
+		*/
+		template <typename Q>
+		bool holds(const Q &key, size_t hash) const {
+			return hash == _hash and key == _pair.first;
+		}
 
 		/** Which alveole coming next ?
 		 * @param[out] ptr memory adress of the next alveole
 		*/
-		Alveole<K,V>* getNext(){ return _next; }
+		Alveole<K,V>* getNext() const { return _next; }
 
 		/** Set the value stored into an alveole
 		 * @param[in] n_value The new value of the pair
 		*/
-		void setValue(V n_value){ _value = n_value; }
+		void setValue(const V &n_value){ _pair.second = n_value; }
 
 		/** Set the next adress of the next alveole
 		 * @param[in] n_next adress of the new next alveole
@@ -197,7 +234,7 @@ class Alveole{
 		 * @param[out] desc a string represention of the alveole
 		*/
 		string toString(){
-			string desc = "{" + _key + ", " + _value + "}";
+			string desc = "{" + _pair.first + ", " + _pair.second + "}";
 			if(END == _next){
 				return desc;
 			} else {
@@ -207,27 +244,603 @@ class Alveole{
 };
 
 /** \brief Maps a key to a value.
+ *
+ * The number of buckets follows the number of pairs stored: the table grows
+ * when the load factor exceeds the maximum load factor and shrinks when it
+ * falls under a quarter of it. Alveoles are moved from the old buckets to the
+ * new ones a few buckets at a time (REHASHSTEP) on each operation, so no
+ * single operation has to rehash the whole table.
+ *
+ * Keys are hashed by a hasher H (see hashers.hpp) and buckets are chosen
+ * with the low bits of the hashcode, the number of buckets being a power of two.
+ * Alveoles are allocated by an allocator policy A (see slaballocator.hpp),
+ * by default from slabs of contiguous alveoles.
 */
-template <typename K, typename V>
+template <typename K, typename V, typename H = DefaultHasher<K>, typename A = SlabAllocator<Alveole<K,V>>>
 class Hashtable {
 
 	private:
 		Alveole<K,V>** _table; /** array of alveoles */
+		unsigned _capacity; /** number of buckets in _table */
+		Alveole<K,V>** _oldTable; /** buckets being moved into _table, END if no rehash is running */
+		unsigned _oldCapacity; /** number of buckets in _oldTable */
+		unsigned _rehashIndex; /** next bucket of _oldTable to move */
+		unsigned _minCapacity; /** the table never shrinks under this number of buckets */
+		unsigned _size; /** number of pairs stored */
+		float _maxLoadFactor; /** load factor over which the table grows */
+		H _hasher; /** computes hashcodes of keys */
+		A _allocator; /** gives memory for alveoles */
+#ifdef HASHTABLE_STATS
+		TableCounters _counters; /** what the table did, see tablestats.hpp */
+#endif
+
+		/** Smallest power of two greater than or equal to n
+		 * @param[in] n a number of buckets
+		 * @param[out] capacity a power of two, at least 1
+		*/
+		static unsigned powerOfTwo(unsigned n){
+			unsigned capacity = 1;
+			while(capacity < n) capacity *= 2;
+			return capacity;
+		}
+
+		/** Make a new alveole with the allocator
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair
+		 * @param[in] hash hashcode of key
+		 * @param[in] next adresse to the next alveole
+		 * @param[out] alveole the new alveole
+		*/
+		Alveole<K,V>* newAlveole(const K &key, const V &value, size_t hash, Alveole<K,V>* next){
+			TABLECOUNT(allocations, 1);
+			return new (_allocator.allocate()) Alveole<K,V>(key, value, hash, next);
+		}
+
+		/** Destroy an alveole and give its memory back to the allocator
+		 * @param[in] alveole the alveole to delete
+		*/
+		void deleteAlveole(Alveole<K,V>* alveole){
+			alveole->~Alveole<K,V>();
+			_allocator.deallocate(alveole);
+		}
+
+		/** Destroy every alveole of a bucket array
+		 * @param[in] table the bucket array
+		 * @param[in] from first bucket to empty
+		 * @param[in] to bucket after the last one to empty
+		*/
+		void destroyAlveoles(Alveole<K,V>** table, unsigned from, unsigned to){
+			for(unsigned i = from; i<to; ++i){
+				Alveole<K,V>* browser = table[i];
+				while(END != browser){
+					Alveole<K,V>* next = browser->getNext();
+					if(A::bulkRelease){
+						// memory is given back all at once after
+						browser->~Alveole<K,V>();
+					}
+					else {
+						deleteAlveole(browser);
+					}
+					browser = next;
+				}
+				table[i] = END;
+			}
+		}
+
+		/** Destroy every alveole and give back the memory of the allocator
+		*/
+		void destroyAll(){
+			// nothing to destroy into the alveoles, the slabs can just go
+			if(not(A::bulkRelease and std::is_trivially_destructible<K>::value and std::is_trivially_destructible<V>::value)){
+				destroyAlveoles(_table, 0, _capacity);
+				if(END != _oldTable) destroyAlveoles(_oldTable, _rehashIndex, _oldCapacity);
+			}
+			_allocator.release();
+			_size = 0;
+		}
+
+		/** Number of buckets to browse to find every alveole
+		 * @param[out] count buckets of _table, then buckets of _oldTable if a rehash is running
+		*/
+		unsigned bucketCount() const {
+			return END != _oldTable ? _capacity + _oldCapacity : _capacity;
+		}
+
+		/** First alveole of a bucket, buckets of _table coming first
+		 * then buckets of _oldTable not moved yet
+		 * @param[in] i index of the bucket, lower than bucketCount()
+		 * @param[out] alveole first alveole of the bucket, END if empty
+		*/
+		Alveole<K,V>* bucketAt(unsigned i) const {
+			if(i < _capacity){
+				return _table[i];
+			}
+			else if(i - _capacity >= _rehashIndex){
+				return _oldTable[i - _capacity];
+			}
+			return END;
+		}
+
+		/** Add a copy of every pair of another hashtable
+		 * Keys must not be in this hashtable already.
+		 * @param[in] other hashtable to copy pairs from
+		*/
+		void copyAlveoles(const Hashtable<K,V,H,A> &other){
+			reserve(other._size);
+			for(unsigned i = 0; i<other.bucketCount(); ++i){
+				Alveole<K,V>* browser = other.bucketAt(i);
+				while(END != browser){
+					unsigned index = browser->getHash() & (_capacity-1);
+					_table[index] = newAlveole(browser->getKey(), browser->getValue(), browser->getHash(), _table[index]);
+					++_size;
+					browser = browser->getNext();
+				}
+			}
+		}
+
+		/** Allocate an array of empty buckets
+		 * @param[in] capacity number of buckets
+		 * @param[out] table the new array
+		*/
+		static Alveole<K,V>** newTable(unsigned capacity){
+			Alveole<K,V>** table = new Alveole<K,V>*[capacity];
+			for(unsigned i = 0; i<capacity; ++i){
+				table[i] = END;
+			}
+			return table;
+		}
+
+		/** Move some buckets of the old array into the current one
+		 * @param[in] steps number of old buckets to move
+		*/
+		void rehashStep(unsigned steps){
+			while(END != _oldTable and 0 < steps--){
+				Alveole<K,V>* browser = _oldTable[_rehashIndex];
+				while(END != browser){
+					Alveole<K,V>* next = browser->getNext();
+					// the hashcode stored into the alveole saves hashing the key again
+					unsigned index = browser->getHash() & (_capacity-1);
+					browser->setNext(_table[index]);
+					_table[index] = browser;
+					browser = next;
+				}
+				_oldTable[_rehashIndex++] = END;
+				// every alveole moved, the old array is useless
+				if(_oldCapacity == _rehashIndex){
+					delete[] _oldTable;
+					_oldTable = END;
+				}
+			}
+		}
+
+		/** Start moving the alveoles into a new array of buckets
+		 * A running rehash is finished first.
+		 * @param[in] capacity number of buckets of the new array
+		*/
+		void resize(unsigned capacity){
+			rehashStep(_oldCapacity);
+			_oldTable = _table;
+			_oldCapacity = _capacity;
+			_rehashIndex = 0;
+			_table = newTable(capacity);
+			_capacity = capacity;
+		}
+
+		/** Grow or shrink the table if the load factor requires it
+		*/
+		void checkLoad(){
+			if(END == _oldTable){
+				if(_size > _maxLoadFactor*_capacity){
+					resize(2*_capacity);
+				}
+				else if(_capacity > _minCapacity and _size < _maxLoadFactor*_capacity/4){
+					resize(_capacity/2 < _minCapacity ? _minCapacity : _capacity/2);
+				}
+			}
+		}
+
+		/** Does an alveole store a key ? The compare is counted.
+		 * @param[in] alveole alveole of a chain
+		 * @param[in] key key to compare
+		 * @param[in] hash hashcode of key
+		 * @param[out] bool true if key is stored into alveole, else false
+		*/
+		template <typename Q>
+		bool matches(const Alveole<K,V>* alveole, const Q &key, size_t hash){
+			TABLECOUNT(compares, 1);
+			return alveole->holds(key, hash);
+		}
+
+		/** Find the alveole storing a key
+		 * @param[in] key key to find
+		 * @param[in] hash hashcode of key
+		 * @param[out] alveole the alveole storing key, END if key is not here
+		*/
+		template <typename Q>
+		Alveole<K,V>* find(const Q &key, size_t hash){
+			Alveole<K,V>* browser = _table[hash & (_capacity-1)];
+			while(END != browser and not matches(browser, key, hash)){
+				browser = browser->getNext();
+			}
+			// the key may still be in a bucket not moved yet
+			if(END == browser and END != _oldTable and (hash & (_oldCapacity-1)) >= _rehashIndex){
+				browser = _oldTable[hash & (_oldCapacity-1)];
+				while(END != browser and not matches(browser, key, hash)){
+					browser = browser->getNext();
+				}
+			}
+			if(END == browser){
+				TABLECOUNT(misses, 1);
+			}
+			else {
+				TABLECOUNT(hits, 1);
+			}
+			return browser;
+		}
+
+		/** Unlink an alveole from a bucket
+		 * @param[in] link adress of the first link of the chain
+		 * @param[in] key key of the alveole to remove
+		 * @param[in] hash hashcode of key
+		 * @param[out] bool true if the alveole was found and deleted, else false
+		*/
+		template <typename Q>
+		bool unlink(Alveole<K,V>** link, const Q &key, size_t hash){
+			Alveole<K,V>* bef = END;
+			Alveole<K,V>* cur = *link;
+			while(END != cur){
+				if(matches(cur, key, hash)){
+					// the first alveole of the chain is held by the bucket itself
+					if(END == bef){
+						*link = cur->getNext();
+					}
+					else {
+						bef->setNext(cur->getNext());
+					}
+					deleteAlveole(cur);
+					return true;
+				}
+				bef = cur;
+				cur = cur->getNext();
+			}
+			return false;
+		}
+
+		/** Find the alveole storing a key, after a rehash step
+		 * @param[in] key key to find
+		 * @param[out] alveole the alveole storing key, END if key is not here
+		*/
+		template <typename Q>
+		Alveole<K,V>* lookup(const Q &key){
+			rehashStep(REHASHSTEP);
+			return find(key, _hasher(key));
+		}
+
+		/** Value maped to a key
+		 * @param[in] key a key in the hashtable
+		 * @param[out] value value associated with the key
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		template <typename Q>
+		const V& valueOf(const Q &key){
+			Alveole<K,V>* browser = lookup(key);
+			if(END == browser){
+				throw HashtableException("Key not found!");
+			} else {
+				return browser->getValue();
+			}
+		}
+
+		/** Find the alveole storing a key, or map the key to a value
+		 * The key is hashed and the chain browsed only once.
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair if key is not here yet
+		 * @param[in] inserted set to true if the pair was added, else false
+		 * @param[out] alveole the alveole storing key
+		*/
+		template <typename Q>
+		Alveole<K,V>* findOrInsert(const Q &key, const V &value, bool &inserted){
+			rehashStep(REHASHSTEP);
+			return findOrInsert(key, _hasher(key), value, inserted);
+		}
+
+		/** Find the alveole storing a key already hashed, or map the key to a value
+		 * @param[in] key key of the pair
+		 * @param[in] hash hashcode of key
+		 * @param[in] value value of the pair if key is not here yet
+		 * @param[in] inserted set to true if the pair was added, else false
+		 * @param[out] alveole the alveole storing key
+		*/
+		template <typename Q>
+		Alveole<K,V>* findOrInsert(const Q &key, size_t hash, const V &value, bool &inserted){
+			Alveole<K,V>* browser = find(key, hash);
+			inserted = (END == browser);
+			if(inserted){
+				// where to put the pair ?
+				unsigned index = hash & (_capacity-1);
+				browser = newAlveole(K(key), value, hash, _table[index]);
+				_table[index] = browser;
+				++_size;
+				checkLoad();
+			}
+			return browser;
+		}
+
+		/** Map a key to a value, or update the value maped to the key
+		 * @param[in] key key of the pair
+		 * @param[in] value value of the pair
+		*/
+		template <typename Q>
+		void insert(const Q &key, const V &value){
+			bool inserted;
+			Alveole<K,V>* browser = findOrInsert(key, value, inserted);
+			if(not inserted){
+				browser->setValue(value);
+			}
+		}
+
+		/** Hash a chunk of keys and prefetch their buckets, then the first
+		 * alveoles of the buckets, so the cache misses of the keys overlap
+		 * instead of waiting for each other.
+		 * @param[in] keys keys of the chunk
+		 * @param[in] count number of keys, at most BATCHSIZE
+		 * @param[in] hashes set to the hashcodes of the keys
+		*/
+		template <typename Q>
+		void prefetchBatch(const Q* keys, size_t count, size_t* hashes){
+			for(size_t i = 0; i<count; ++i){
+				hashes[i] = _hasher(keys[i]);
+			}
+			prefetchHashed(hashes, count);
+		}
+
+		/** Prefetch the buckets of a chunk of hashcodes, then the first
+		 * alveoles of the buckets
+		 * @param[in] hashes hashcodes of the keys of the chunk
+		 * @param[in] count number of hashcodes, at most BATCHSIZE
+		*/
+		void prefetchHashed(const size_t* hashes, size_t count){
+			// buckets are moved before prefetching, so they stay where they are
+			rehashStep(REHASHSTEP*count);
+			for(size_t i = 0; i<count; ++i){
+				__builtin_prefetch(&_table[hashes[i] & (_capacity-1)]);
+			}
+			for(size_t i = 0; i<count; ++i){
+				Alveole<K,V>* first = _table[hashes[i] & (_capacity-1)];
+				if(END != first) __builtin_prefetch(first);
+			}
+		}
+
+		/** Remove a key and its value
+		 * @param[in] key Key of the pair to delete
+		 * @exception HashtableException threw if table does not contain key
+		*/
+		template <typename Q>
+		void erase(const Q &key){
+			rehashStep(REHASHSTEP);
+			size_t hash = _hasher(key);
+			bool done = unlink(&_table[hash & (_capacity-1)], key, hash);
+			if(not done and END != _oldTable and (hash & (_oldCapacity-1)) >= _rehashIndex){
+				done = unlink(&_oldTable[hash & (_oldCapacity-1)], key, hash);
+			}
+			if(not done){
+				TABLECOUNT(misses, 1);
+				throw HashtableException("Key is not here!");
+			}
+			TABLECOUNT(hits, 1);
+			--_size;
+			checkLoad();
+		}
 
 	public:
+		/** \brief Forward iterator over the pairs of a Hashtable.
+		 *
+		 * Yields references to the pairs stored into the alveoles, nothing
+		 * is copied. Putting or removing keys invalidates the iterators.
+		*/
+		template <bool Const>
+		class Iterator {
+			friend class Hashtable<K,V,H,A>;
+			template <bool> friend class Iterator;
+
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef pair<const K,V> value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+				typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+			private:
+				const Hashtable<K,V,H,A>* _owner; /** browsed hashtable */
+				unsigned _bucket; /** bucket of the current alveole */
+				Alveole<K,V>* _alveole; /** current alveole, END at the end */
+
+				/** Constructor, used by begin() and end()
+				 * @param[in] owner browsed hashtable
+				 * @param[in] bucket first bucket to look in
+				*/
+				Iterator(const Hashtable<K,V,H,A>* owner, unsigned bucket):
+				_owner(owner),
+				_bucket(bucket),
+				_alveole(END)
+				{
+					findAlveole();
+				}
+
+				/** Go to the first alveole of the next non empty bucket,
+				 * starting from _bucket
+				*/
+				void findAlveole(){
+					unsigned buckets = _owner->bucketCount();
+					while(_bucket < buckets and END == (_alveole = _owner->bucketAt(_bucket))){
+						++_bucket;
+					}
+				}
+
+			public:
+				/** Empty constructor
+				*/
+				Iterator():
+				_owner(END),
+				_bucket(0),
+				_alveole(END)
+				{}
+
+				/** Conversion constructor, from iterator to const_iterator
+				 * @param[in] other iterator to convert
+				*/
+				Iterator(const Iterator<false> &other):
+				_owner(other._owner),
+				_bucket(other._bucket),
+				_alveole(other._alveole)
+				{}
+
+				/** The pair the iterator is on
+				 * @param[out] pair reference to the stored pair
+				*/
+				reference operator*() const { return _alveole->getPair(); }
+
+				/** Access to the members of the pair the iterator is on
+				 * @param[out] ptr adress of the stored pair
+				*/
+				pointer operator->() const { return &(_alveole->getPair()); }
+
+				/** Go to the next pair
+				 * @param[out] iterator this iterator
+				*/
+				Iterator<Const>& operator++(){
+					_alveole = _alveole->getNext();
+					if(END == _alveole){
+						++_bucket;
+						findAlveole();
+					}
+					return (*this);
+				}
+
+				/** Go to the next pair
+				 * @param[out] iterator a copy of the iterator before moving
+				*/
+				Iterator<Const> operator++(int){
+					Iterator<Const> before = (*this);
+					++(*this);
+					return before;
+				}
+
+				/** equality operator
+				 * @param[in] rhs iterator to compare
+				 * @param[out] bool true if both iterators are on the same pair
+				*/
+				template <bool C>
+				bool operator==(const Iterator<C> &rhs) const { return _alveole == rhs._alveole; }
+
+				/** inequality operator
+				 * @param[in] rhs iterator to compare
+				 * @param[out] bool true if iterators are not on the same pair
+				*/
+				template <bool C>
+				bool operator!=(const Iterator<C> &rhs) const { return _alveole != rhs._alveole; }
+		};
+
+		/// iterator over pairs, values can be updated
+		typedef Iterator<false> iterator;
+		/// iterator over pairs, read only
+		typedef Iterator<true> const_iterator;
+		/// type of the keys
+		typedef K key_type;
+		/// type of the values
+		typedef V mapped_type;
+
 		/** Simple constructor
 		*/
-		Hashtable(){
-			_table = new Alveole<K,V>*[ARRAYSIZE];
-			for(int i = 0; i<ARRAYSIZE; ++i){
-				_table[i] = END;
-			}
+		Hashtable():
+		_table(newTable(powerOfTwo(ARRAYSIZE))),
+		_capacity(powerOfTwo(ARRAYSIZE)),
+		_oldTable(END),
+		_oldCapacity(0),
+		_rehashIndex(0),
+		_minCapacity(_capacity),
+		_size(0),
+		_maxLoadFactor(MAXLOADFACTOR)
+		{}
+
+		/** Capacity constructor
+		 * @param[in] capacity initial number of buckets, rounded up to a power of two,
+		 * the table never shrinks under it
+		 * @param[in] maxLoadFactor load factor over which the table grows
+		 * @param[in] hasher hash function of the table, e.g. a seeded WyHasher
+		 * @exception HashtableException threw if maxLoadFactor is not positive
+		*/
+		Hashtable(unsigned capacity, float maxLoadFactor = MAXLOADFACTOR, const H &hasher = H()):
+		_table(END),
+		_capacity(powerOfTwo(capacity)),
+		_oldTable(END),
+		_oldCapacity(0),
+		_rehashIndex(0),
+		_minCapacity(_capacity),
+		_size(0),
+		_maxLoadFactor(maxLoadFactor),
+		_hasher(hasher)
+		{
+			if(not(0 < maxLoadFactor)) throw HashtableException("Load factor must be positive!");
+			_table = newTable(_capacity);
+		}
+
+		/** Copy constructor
+		 * @param[in] other hashtable to copy, alveoles are copied too
+		*/
+		Hashtable(const Hashtable<K,V,H,A> &other):
+		_table(newTable(other._minCapacity)),
+		_capacity(other._minCapacity),
+		_oldTable(END),
+		_oldCapacity(0),
+		_rehashIndex(0),
+		_minCapacity(other._minCapacity),
+		_size(0),
+		_maxLoadFactor(other._maxLoadFactor),
+		_hasher(other._hasher)
+		{
+			copyAlveoles(other);
 		}
 
 		/** Destructor
+		 * every alveole is destroyed, and their memory released at once
 		*/
 		~Hashtable(){
+			destroyAll();
 			delete[] _table;
+			delete[] _oldTable;
+		}
+
+		/** assignment operator overload
+		 * @param[in] other hashtable to copy, alveoles are copied too
+		 * @param[out] hashtable assigned hashtable
+		*/
+		Hashtable<K,V,H,A>& operator=(const Hashtable<K,V,H,A> &other){
+			// prevent objet copying itself
+			if(this != &other){
+				// same shrink floor as a copy, clear starts from it
+				_minCapacity = other._minCapacity;
+				clear();
+				_maxLoadFactor = other._maxLoadFactor;
+				// stored hashcodes are reused, they must come from the same hasher
+				_hasher = other._hasher;
+				copyAlveoles(other);
+			}
+			return (*this); // allow a = b = c
+		}
+
+		/** Remove every pair from this hashtable
+		 * Memory of the alveoles is released at once.
+		*/
+		void clear(){
+			destroyAll();
+			delete[] _table;
+			delete[] _oldTable;
+			_oldTable = END;
+			_oldCapacity = 0;
+			_rehashIndex = 0;
+			_capacity = _minCapacity;
+			_table = newTable(_capacity);
 		}
 
 		/** Do table contains key ?
@@ -235,18 +848,16 @@ class Hashtable {
 		 * @param[out] bool True if the key is here, else false
 		*/
 		bool contains(const K &key){
-			bool here = false;
-			int index = computehash<K>(key)%ARRAYSIZE;
-			assert(index>=0);
-			assert(index<ARRAYSIZE);
-			Alveole<K,V>* browser = _table[index];
-			while(not here and END != browser){
-				if(key == browser->getKey()){
-					here = true;
-				}
-				browser = browser->getNext();
-				}
-			return here;
+			return END != lookup(key);
+		}
+
+		/** Do table contains key ? Lookup without building a K.
+		 * @param[in] key key to find, e.g. a string_view for string keys
+		 * @param[out] bool True if the key is here, else false
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		bool contains(const Q &key){
+			return END != lookup(key);
 		}
 
 		/** Return the value maped to the specified key
@@ -254,37 +865,89 @@ class Hashtable {
 		 * @param[out] value value associated with the key
 		 * @exception HashtableException threw if key is not in the hashtable
 		*/
-		V get(const K &key){
-			int index = computehash<K>(key)%ARRAYSIZE;
-			assert(index>=0);
-			assert(index<ARRAYSIZE);
-			Alveole<K,V>* browser = _table[index];
-			bool undone = true;
-			while(undone and END != browser){
-				if(key == browser->getKey()){
-					undone = false;
-				}
-				else {
-					browser = browser->getNext();
-				}
-			}
-			if(undone){
-				throw HashtableException("Key not found!");
-			} else {
-				return browser->getValue();
-			}
+		const V& get(const K &key){
+			return valueOf(key);
+		}
+
+		/** Return the value maped to the specified key, without building a K.
+		 * @param[in] key a key in the hashtable, e.g. a string_view for string keys
+		 * @param[out] value value associated with the key
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		const V& get(const Q &key){
+			return valueOf(key);
 		}
 
 		/** Tests if this hashtable maps no keys to values.
 		 * @param[out] bool true if no elements in the hashtable, else false;
 		*/
 		bool isEmpty(){
-			bool empty = true;
-			int i = 0;
-			while(empty and i<ARRAYSIZE){
-				empty = (END == _table[i++]);
+			return 0 == _size;
+		}
+
+		/** Number of pairs stored in the hashtable
+		 * @param[out] size number of keys
+		*/
+		unsigned size(){ return _size; }
+
+		/** Number of buckets of the hashtable
+		 * @param[out] capacity number of buckets pairs are currently put in
+		*/
+		unsigned capacity(){ return _capacity; }
+
+		/** Average number of pairs per bucket
+		 * @param[out] loadFactor size divided by capacity
+		*/
+		float loadFactor(){ return (float)_size/_capacity; }
+
+		/** How the pairs are spread over the buckets, and the counters
+		 * of the table if HASHTABLE_STATS is defined
+		 * Buckets of a running rehash not moved yet are counted as well.
+		 * @param[out] stats statistics of the table
+		*/
+		TableStats stats() const {
+			TableStats stats;
+			unsigned long probes = 0;
+			for(unsigned i = 0; i<bucketCount(); ++i){
+				// buckets of _oldTable already moved are not used anymore
+				if(i >= _capacity and i - _capacity < _rehashIndex) continue;
+				unsigned length = 0;
+				for(Alveole<K,V>* browser = bucketAt(i); END != browser; browser = browser->getNext()){
+					probes += ++length;
+				}
+				stats.addBucket(length);
+				if(stats.maxProbe < length) stats.maxProbe = length;
+			}
+			stats.size = _size;
+			stats.loadFactor = (float)_size/_capacity;
+			stats.meanProbe = 0 < _size ? (float)probes/_size : 0;
+#ifdef HASHTABLE_STATS
+			stats.counters = _counters;
+#endif
+			return stats;
+		}
+
+		/** Change the load factor over which the table grows
+		 * @param[in] maxLoadFactor the new maximum load factor
+		 * @exception HashtableException threw if maxLoadFactor is not positive
+		*/
+		void setMaxLoadFactor(float maxLoadFactor){
+			if(not(0 < maxLoadFactor)) throw HashtableException("Load factor must be positive!");
+			_maxLoadFactor = maxLoadFactor;
+			checkLoad();
+		}
+
+		/** Make room for at least n pairs without growing again
+		 * Usefull before loading many pairs at once.
+		 * @param[in] n number of pairs the table will store
+		*/
+		void reserve(unsigned n){
+			unsigned capacity = powerOfTwo((unsigned)(n/_maxLoadFactor) + 1);
+			if(capacity > _capacity){
+				resize(capacity);
+				rehashStep(_oldCapacity);
 			}
-			return empty;
 		}
 
 		/** Map the specified key to the specified value in this hashtable.
@@ -292,26 +955,214 @@ class Hashtable {
 		 * @param[in] key key of the pair
 		 * @param[in] value value of the pair
 		*/
-		// TODO: optimize this fucking code
-		void put(K key, V value){
-			// where to put the pair ?
-			int index = computehash<K>(key)%ARRAYSIZE;
-			assert(index>=0);
-			assert(index<ARRAYSIZE);
-			// browse alveoles at this place
-			Alveole<K,V>* browser = _table[index];
-			bool undone = true;
-			while(undone and END != browser){
-				if(key == browser->getKey()){
-					//std::cout << "Updating (" << key << ", " << value <<") at " << index << std::endl; // debug line
-					browser->setValue(value);
-					undone = false;
+		void put(const K &key, const V &value){
+			insert(key, value);
+		}
+
+		/** Map the specified key to the specified value in this hashtable.
+		 * or update the maped value to the key
+		 * A K is built from key only if key is not in the table yet.
+		 * @param[in] key key of the pair, e.g. a string_view for string keys
+		 * @param[in] value value of the pair
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		void put(const Q &key, const V &value){
+			insert(key, value);
+		}
+
+		/** Get the value maped to a key, mapping the key to value first if
+		 * the key is not in the table. The key is looked up only once.
+		 * @param[in] key key of the pair
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[out] value reference to the value maped to key, to update it
+		*/
+		V& upsert(const K &key, const V &value){
+			bool inserted;
+			return findOrInsert(key, value, inserted)->getValue();
+		}
+
+		/** Get the value maped to a key, mapping the key to value first if
+		 * the key is not in the table. The key is looked up only once.
+		 * @param[in] key key of the pair, e.g. a string_view for string keys
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[out] value reference to the value maped to key, to update it
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		V& upsert(const Q &key, const V &value){
+			bool inserted;
+			return findOrInsert(key, value, inserted)->getValue();
+		}
+
+		/** Update the value maped to a key with a function, or map the key
+		 * to value if the key is not in the table. The key is looked up only once.
+		 * @param[in] key key of the pair
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[in] update function called with a reference to the value maped to key, if key was here
+		 * @param[out] value reference to the value maped to key
+		*/
+		template <typename F>
+		V& upsert(const K &key, const V &value, F update){
+			bool inserted;
+			V &mapped = findOrInsert(key, value, inserted)->getValue();
+			if(not inserted) update(mapped);
+			return mapped;
+		}
+
+		/** Update the value maped to a key with a function, or map the key
+		 * to value if the key is not in the table. The key is looked up only once.
+		 * @param[in] key key of the pair, e.g. a string_view for string keys
+		 * @param[in] value value maped to key if key is not here yet
+		 * @param[in] update function called with a reference to the value maped to key, if key was here
+		 * @param[out] value reference to the value maped to key
+		*/
+		template <typename Q, typename F, typename = EnableLookup<Q,K>>
+		V& upsert(const Q &key, const V &value, F update){
+			bool inserted;
+			V &mapped = findOrInsert(key, value, inserted)->getValue();
+			if(not inserted) update(mapped);
+			return mapped;
+		}
+
+		/** Map keys to values, as put does for each pair
+		 * Keys are hashed and their buckets prefetched BATCHSIZE at a time
+		 * before being put.
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] values array of values, values[i] is maped to keys[i]
+		 * @param[in] count number of pairs
+		*/
+		template <typename Q>
+		void putBatch(const Q* keys, const V* values, size_t count){
+			size_t hashes[BATCHSIZE];
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchBatch(keys + start, n, hashes);
+				for(size_t i = 0; i<n; ++i){
+					bool inserted;
+					Alveole<K,V>* browser = findOrInsert(keys[start+i], hashes[i], values[start+i], inserted);
+					if(not inserted) browser->setValue(values[start+i]);
 				}
-				browser = browser->getNext();
 			}
-			if(undone){
-				_table[index] = new Alveole<K,V>(key, value, _table[index]);
-				//std::cout << "Adding (" << key << ", " << value <<") at " << index << std::endl; // debug line
+		}
+
+		/** Find the values maped to keys
+		 * Keys are hashed and their buckets prefetched BATCHSIZE at a time
+		 * before being looked up. Putting or removing keys invalidates the
+		 * adresses of the values.
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] count number of keys
+		 * @param[in] values array set to the adresses of the values, nullptr if a key is not here
+		 * @param[out] found number of keys found
+		*/
+		template <typename Q>
+		size_t getBatch(const Q* keys, size_t count, const V** values){
+			size_t hashes[BATCHSIZE];
+			size_t found = 0;
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchBatch(keys + start, n, hashes);
+				for(size_t i = 0; i<n; ++i){
+					Alveole<K,V>* browser = find(keys[start+i], hashes[i]);
+					values[start+i] = END == browser ? nullptr : &browser->getValue();
+					if(END != browser) ++found;
+				}
+			}
+			return found;
+		}
+
+		/** Update the values maped to keys with a function, or map the keys
+		 * not in the table to value, as upsert does for each key
+		 * Keys are hashed and their buckets prefetched BATCHSIZE at a time
+		 * before being updated.
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] count number of keys
+		 * @param[in] value value maped to keys not here yet
+		 * @param[in] update function called with a reference to the value maped to each key already here
+		 * @param[out] inserted array set to true for each key maped to value, not here before, nullptr if unused
+		*/
+		template <typename Q, typename F>
+		void upsertBatch(const Q* keys, size_t count, const V &value, F update, bool* inserted = nullptr){
+			size_t hashes[BATCHSIZE];
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchBatch(keys + start, n, hashes);
+				for(size_t i = 0; i<n; ++i){
+					bool isNew;
+					Alveole<K,V>* browser = findOrInsert(keys[start+i], hashes[i], value, isNew);
+					if(not isNew) update(browser->getValue());
+					if(nullptr != inserted) inserted[start+i] = isNew;
+				}
+			}
+		}
+
+		/** Map some keys of an array to values, as putBatch does, with
+		 * their hashcodes already computed, e.g. by a table spreading keys
+		 * over several Hashtable (see ConcurrentHashtable)
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] values array of values, values[j] is maped to keys[j]
+		 * @param[in] indexes indexes in keys of the keys to put
+		 * @param[in] hashes hashcodes of the keys, hashes[i] is the one of keys[indexes[i]]
+		 * @param[in] count number of indexes
+		*/
+		template <typename Q>
+		void putHashed(const Q* keys, const V* values, const uint32_t* indexes, const size_t* hashes, size_t count){
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchHashed(hashes + start, n);
+				for(size_t i = 0; i<n; ++i){
+					bool inserted;
+					uint32_t j = indexes[start+i];
+					Alveole<K,V>* browser = findOrInsert(keys[j], hashes[start+i], values[j], inserted);
+					if(not inserted) browser->setValue(values[j]);
+				}
+			}
+		}
+
+		/** Find the values maped to some keys of an array, as getBatch
+		 * does, with their hashcodes already computed
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] indexes indexes in keys of the keys to find
+		 * @param[in] hashes hashcodes of the keys, hashes[i] is the one of keys[indexes[i]]
+		 * @param[in] count number of indexes
+		 * @param[in] values array set to the adresses of the values, values[i]
+		 * for keys[indexes[i]], nullptr if the key is not here
+		 * @param[out] found number of keys found
+		*/
+		template <typename Q>
+		size_t getHashed(const Q* keys, const uint32_t* indexes, const size_t* hashes, size_t count, const V** values){
+			size_t found = 0;
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchHashed(hashes + start, n);
+				for(size_t i = 0; i<n; ++i){
+					Alveole<K,V>* browser = find(keys[indexes[start+i]], hashes[start+i]);
+					values[start+i] = END == browser ? nullptr : &browser->getValue();
+					if(END != browser) ++found;
+				}
+			}
+			return found;
+		}
+
+		/** Update the values maped to some keys of an array, or map them
+		 * to value, as upsertBatch does, with their hashcodes already computed
+		 * @param[in] keys array of keys, K or any type Hashtable looks up
+		 * @param[in] indexes indexes in keys of the keys to update
+		 * @param[in] hashes hashcodes of the keys, hashes[i] is the one of keys[indexes[i]]
+		 * @param[in] count number of indexes
+		 * @param[in] value value maped to keys not here yet
+		 * @param[in] update function called with a reference to the value maped to each key already here
+		 * @param[out] inserted array, inserted[j] set to true if keys[j] is maped to value, nullptr if unused
+		*/
+		template <typename Q, typename F>
+		void upsertHashed(const Q* keys, const uint32_t* indexes, const size_t* hashes, size_t count, const V &value, F update, bool* inserted = nullptr){
+			for(size_t start = 0; start<count; start += BATCHSIZE){
+				size_t n = count - start < BATCHSIZE ? count - start : BATCHSIZE;
+				prefetchHashed(hashes + start, n);
+				for(size_t i = 0; i<n; ++i){
+					bool isNew;
+					Alveole<K,V>* browser = findOrInsert(keys[indexes[start+i]], hashes[start+i], value, isNew);
+					if(not isNew) update(browser->getValue());
+					if(nullptr != inserted) inserted[indexes[start+i]] = isNew;
+				}
 			}
 		}
 
@@ -319,30 +1170,17 @@ class Hashtable {
 		 * @param[in] key Key of the pair to delete
 		 * @exception HashtableException threw if table does not contain key
 		*/
-		/// FIXME : remove last element of a list lead to a seg. fault
 		void remove(const K &key){
-			int index = computehash<K>(key)%ARRAYSIZE;
-			assert(index>=0);
-			assert(index<ARRAYSIZE);
-			Alveole<K,V>* bef = new Alveole<K,V>();
-			bef->setNext(_table[index]);
-			Alveole<K,V>* cur = _table[index];
-			bool undone = true;
-			while(undone and END != cur){
-				//std::cout << cur->toString() << std::endl; // debug line
-				if(key == cur->getKey()){
-					bef->setNext(cur->getNext());
-					assert(bef->getNext() == cur->getNext());
-					undone = false;
-					delete cur;
-				}
-				else {
-					assert(cur != END);
-					bef = cur;
-					cur = cur->getNext();
-				}
-			}
-			if(undone) throw HashtableException("Key is not here!");
+			erase(key);
+		}
+
+		/** Remove the key (and its corresponding value) from this hashtable.
+		 * @param[in] key Key of the pair to delete, e.g. a string_view for string keys
+		 * @exception HashtableException threw if table does not contain key
+		*/
+		template <typename Q, typename = EnableLookup<Q,K>>
+		void remove(const Q &key){
+			erase(key);
 		}
 
 		/** Return a description of the hashtable, enclosed in braces as
@@ -351,28 +1189,66 @@ class Hashtable {
 		 */
 		string toString(){
 			string desc = "[";
-			for(int i = 0; i<ARRAYSIZE; ++i){
+			for(unsigned i = 0; i<_capacity; ++i){
 				if(END != _table[i]){
 					desc.size()<2?desc += (_table[i]->toString()):desc += ", " + (_table[i]->toString());
 				}
 			}
+			for(unsigned i = _rehashIndex; END != _oldTable and i<_oldCapacity; ++i){
+				if(END != _oldTable[i]){
+					desc.size()<2?desc += (_oldTable[i]->toString()):desc += ", " + (_oldTable[i]->toString());
+				}
+			}
 			return desc + "]";
 		}
 		
 		/** Get a list of all kay and their value in pairs
+		 * Pairs are copied, prefer browsing the table with its iterators.
 		 * @param[in] pairs Vector which contains keys to find
 		 */
 		 void getPairs(forward_list<pair<string, int>> &pairs){
-			// we can browse Alveole with it
-			Alveole<K, V>* browser;
-			// For each cell in _table
-			for(int i=0; i<ARRAYSIZE; ++i){
-				// browse alveoli here
-				browser = _table[i];
-				while(END != browser){
-					pairs.push_front(pair<string, int>(browser->getKey(), browser->getValue()));
-					browser = browser->getNext();
-				}
+			for(const pair<const K,V> &stored : *this){
+				pairs.push_front(pair<string, int>(stored.first, stored.second));
+			}
+		}
+
+		/** Iterator on the first pair
+		 * @param[out] iterator iterator on the first pair, end() if the table is empty
+		*/
+		iterator begin(){ return iterator(this, 0); }
+
+		/** Iterator after the last pair
+		 * @param[out] iterator iterator after the last pair
+		*/
+		iterator end(){ return iterator(); }
+
+		/** Iterator on the first pair, read only
+		 * @param[out] iterator iterator on the first pair, end() if the table is empty
+		*/
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		/** Iterator after the last pair, read only
+		 * @param[out] iterator iterator after the last pair
+		*/
+		const_iterator end() const { return const_iterator(); }
+
+		/** Iterator on the first pair, read only
+		 * @param[out] iterator iterator on the first pair, end() if the table is empty
+		*/
+		const_iterator cbegin() const { return begin(); }
+
+		/** Iterator after the last pair, read only
+		 * @param[out] iterator iterator after the last pair
+		*/
+		const_iterator cend() const { return end(); }
+
+		/** Call a function on every pair
+		 * @param[in] visit function called with a const reference to each pair
+		*/
+		template <typename F>
+		void forEach(F visit) const {
+			for(const_iterator it = begin(); it != end(); ++it){
+				visit(*it);
 			}
 		}
 
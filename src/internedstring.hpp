@@ -0,0 +1,280 @@
+/**
+ * @file internedstring.hpp
+ *
+ * @section desc File description
+ *
+ * compact string keys for hashtables : short strings are stored inline,
+ * longer ones are copied once into an append-only arena
+ *
+ * Use InternedString as the key type of a Hashtable to store string keys
+ * in 16 bytes instead of a std::string and its heap allocation, e.g.
+ * Hashtable<InternedString,int>. Keys can still be looked up with
+ * std::string, std::string_view or C strings.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef INTERNEDSTRING_HPP
+#define INTERNEDSTRING_HPP
+
+/// macro to define the size of the chunks of the string arena
+#ifndef ARENACHUNK
+#define ARENACHUNK 65536
+#endif
+
+// included files section
+#include <mutex>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <string_view>
+#include "hashers.hpp"
+
+/** \brief Append-only storage for the characters of strings.
+ *
+ * Strings are copied one after the other into chunks of ARENACHUNK bytes,
+ * a string longer than a quarter of a chunk gets a chunk of its own.
+ * Stored strings never move and are only freed with the arena, all at once.
+ * Strings can be stored by several threads at once.
+*/
+class StringArena {
+	private:
+		std::vector<char*> _chunks; /** every chunk allocated */
+		char* _current; /** chunk strings are copied into */
+		size_t _used; /** number of bytes of _current already used */
+		size_t _bytes; /** number of bytes of strings stored */
+		std::mutex _lock; /** lock of the arena */
+
+	public:
+		/** Simple constructor
+		 * no memory is allocated before the first string
+		*/
+		StringArena():
+		_current(nullptr),
+		_used(ARENACHUNK),
+		_bytes(0)
+		{}
+
+		/// stored strings are referenced by their adress, the arena cannot be copied
+		StringArena(const StringArena &other) = delete;
+
+		/// stored strings are referenced by their adress, the arena cannot be copied
+		StringArena& operator=(const StringArena &other) = delete;
+
+		/** Destructor, frees every chunk
+		*/
+		~StringArena(){
+			for(char* chunk : _chunks){
+				delete[] chunk;
+			}
+		}
+
+		/** Copy characters into the arena
+		 * @param[in] data characters to copy
+		 * @param[in] length number of characters
+		 * @param[out] stored adress of the copy, valid as long as the arena
+		*/
+		const char* store(const char* data, size_t length){
+			std::lock_guard<std::mutex> guard(_lock);
+			char* stored;
+			if(ARENACHUNK/4 < length){
+				stored = new char[length];
+				_chunks.push_back(stored);
+			}
+			else {
+				if(ARENACHUNK - _used < length){
+					_current = new char[ARENACHUNK];
+					_chunks.push_back(_current);
+					_used = 0;
+				}
+				stored = _current + _used;
+				_used += length;
+			}
+			std::memcpy(stored, data, length);
+			_bytes += length;
+			return stored;
+		}
+
+		/** Number of bytes of strings stored
+		 * @param[out] bytes bytes copied into the arena
+		*/
+		size_t bytes(){
+			std::lock_guard<std::mutex> guard(_lock);
+			return _bytes;
+		}
+
+		/** Arena of the InternedString, living as long as the program
+		 * @param[out] arena the global arena
+		*/
+		static StringArena& global(){
+			static StringArena arena;
+			return arena;
+		}
+};
+
+/** \brief String key of 16 bytes, without allocation for short strings.
+ *
+ * Strings of INLINESIZE characters or less are stored in the object itself.
+ * Longer strings are copied into the global StringArena and referenced by
+ * their adress and length: copying an InternedString never copies them
+ * again, and they are never freed. Fits vocabularies kept until the end
+ * of the program.
+ * The last byte is the length of an inline string, or ARENA.
+*/
+class InternedString {
+	private:
+		/// last byte of a string stored into the arena
+		static const unsigned char ARENA = 0xFF;
+
+		/** characters and length of an inline string, or adress and length of a string of the arena */
+		char _bytes[16];
+
+		/** Is the string stored into the arena ?
+		 * @param[out] bool true if the string is into the arena, false if inline
+		*/
+		bool inArena() const { return ARENA == (unsigned char)_bytes[15]; }
+
+	public:
+		/// longest string stored inline
+		static const size_t INLINESIZE = 15;
+
+		/** Simple constructor, an empty string
+		*/
+		InternedString(){
+			std::memset(_bytes, 0, sizeof(_bytes));
+		}
+
+		/** Constructor, copies the string inline or into the arena
+		 * Explicit, so looking a string_view up in a table does not copy it.
+		 * @param[in] str the string
+		*/
+		explicit InternedString(std::string_view str){
+			std::memset(_bytes, 0, sizeof(_bytes));
+			if(INLINESIZE >= str.size()){
+				std::memcpy(_bytes, str.data(), str.size());
+				_bytes[15] = (char)str.size();
+			}
+			else {
+				const char* stored = StringArena::global().store(str.data(), str.size());
+				uint32_t length = (uint32_t)str.size();
+				std::memcpy(_bytes, &stored, sizeof(stored));
+				std::memcpy(_bytes + 8, &length, sizeof(length));
+				_bytes[15] = (char)ARENA;
+			}
+		}
+
+		/** Number of characters
+		 * @param[out] size length of the string
+		*/
+		size_t size() const {
+			if(not inArena()) return (unsigned char)_bytes[15];
+			uint32_t length;
+			std::memcpy(&length, _bytes + 8, sizeof(length));
+			return length;
+		}
+
+		/** Characters of the string, not ended by a null character
+		 * @param[out] data adress of the first character
+		*/
+		const char* data() const {
+			if(not inArena()) return _bytes;
+			const char* stored;
+			std::memcpy(&stored, _bytes, sizeof(stored));
+			return stored;
+		}
+
+		/** The string as a string_view, to hash, compare or print it
+		 * @param[out] view view of the characters
+		*/
+		operator std::string_view() const {
+			return std::string_view(data(), size());
+		}
+
+		/** Is this string equal to another one ?
+		 * Inline strings are zero padded, the 16 bytes are compared at once.
+		 * @param[in] other the other string
+		 * @param[out] bool true if the characters are the same, else false
+		*/
+		bool operator==(const InternedString &other) const {
+			if(not inArena() or not other.inArena()){
+				return 0 == std::memcmp(_bytes, other._bytes, sizeof(_bytes));
+			}
+			return std::string_view(*this) == std::string_view(other);
+		}
+
+		/** Is this string different from another one ?
+		 * @param[in] other the other string
+		 * @param[out] bool true if the characters are not the same, else false
+		*/
+		bool operator!=(const InternedString &other) const { return not(*this == other); }
+};
+
+/** Compare a string with an InternedString, used to look keys up
+ * @param[in] str a string_view, or a string or C string converted into one
+ * @param[in] interned an InternedString
+ * @param[out] bool true if the characters are the same, else false
+*/
+inline bool operator==(std::string_view str, const InternedString &interned){
+	return str == std::string_view(interned);
+}
+
+/** Compare an InternedString with a string
+ * @param[in] interned an InternedString
+ * @param[in] str a string_view, or a string or C string converted into one
+ * @param[out] bool true if the characters are the same, else false
+*/
+inline bool operator==(const InternedString &interned, std::string_view str){
+	return str == std::string_view(interned);
+}
+
+/** Compare a string with an InternedString
+ * @param[in] str a string_view, or a string or C string converted into one
+ * @param[in] interned an InternedString
+ * @param[out] bool true if the characters are not the same, else false
+*/
+inline bool operator!=(std::string_view str, const InternedString &interned){
+	return not(str == interned);
+}
+
+/** Compare an InternedString with a string
+ * @param[in] interned an InternedString
+ * @param[in] str a string_view, or a string or C string converted into one
+ * @param[out] bool true if the characters are not the same, else false
+*/
+inline bool operator!=(const InternedString &interned, std::string_view str){
+	return not(str == interned);
+}
+
+/** \brief InternedStrings are hashed by WyHasher, as the strings they hold
+*/
+template <>
+class DefaultHasher<InternedString> : public WyHasher {
+	public:
+		using WyHasher::WyHasher;
+};
+
+#endif // INTERNEDSTRING_HPP
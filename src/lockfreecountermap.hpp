@@ -0,0 +1,437 @@
+/**
+ * @file lockfreecountermap.hpp
+ *
+ * @section desc File description
+ *
+ * map from keys to counters, usable by several threads at once without lock
+ * pairs are stored in a single list sorted in split order, and buckets are
+ * shortcuts into this list (Shalev & Shavit split-ordered list)
+ *
+ * the hash function is a template parameter, see hashers.hpp
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef LOCKFREECOUNTERMAP_HPP
+#define LOCKFREECOUNTERMAP_HPP
+
+/// macro to define the mean number of keys per bucket over which buckets are doubled
+#ifndef COUNTERLOADFACTOR
+#define COUNTERLOADFACTOR 2
+#endif
+
+// included files section
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "hashtable.hpp"
+#include "concurrenthashtable.hpp"
+
+/** \brief Maps keys to counters, without lock.
+ *
+ * Every pair is a node of one linked list, sorted by the bits of the
+ * hashcodes reversed (split order). A bucket is a dummy node of the list,
+ * the keys of a bucket follow it. Doubling the number of buckets only adds
+ * dummy nodes in the list : no key ever moves.
+ *
+ * - new keys are linked with a compare-and-swap, no thread ever waits for another one
+ * - incrementing the counter of a key already here is a single fetch_add
+ * - keys are never removed while the map is used, so a thread never reads
+ *   a freed node : nodes are only freed by the destructor
+ *
+ * Keys are hashed by a hasher H (see hashers.hpp), the split order only
+ * uses the 32 low bits of the hashcodes. Counters are atomic V, an integer type.
+*/
+template <typename K, typename V = long, typename H = DefaultHasher<K>>
+class LockFreeCounterMap {
+
+	private:
+		/** \brief A node of the split-ordered list */
+		struct CounterNode {
+			uint32_t order; /** reversed hashcode, lowest bit set for keys and unset for buckets */
+			std::atomic<CounterNode*> next; /** next node of the list */
+			std::atomic<V> count; /** counter of the key */
+			K key; /** the key, unused for buckets */
+
+			/** Bucket constructor
+			 * @param[in] order split order of the bucket
+			*/
+			explicit CounterNode(uint32_t order):
+			order(order),
+			next(nullptr),
+			count(0),
+			key()
+			{}
+
+			/** Key constructor
+			 * @param[in] order split order of the key
+			 * @param[in] key the key
+			 * @param[in] count initial value of the counter
+			*/
+			CounterNode(uint32_t order, const K &key, V count):
+			order(order),
+			next(nullptr),
+			count(count),
+			key(key)
+			{}
+		};
+
+		/// number of bucket segments, segment s holds buckets [2^(s-1), 2^s)
+		static const unsigned SEGMENTS = 33;
+
+		std::atomic<std::atomic<CounterNode*>*> _segments[SEGMENTS]; /** segments of buckets, allocated when needed */
+		std::atomic<unsigned> _bucketCount; /** number of buckets used, a power of two */
+		std::atomic<unsigned> _size; /** number of keys */
+		H _hasher; /** computes hashcodes of keys */
+
+		/** Bits of x in reverse order
+		 * @param[in] x a 32 bits integer
+		 * @param[out] reversed bit 0 of x is bit 31 of reversed, and so on
+		*/
+		static uint32_t reverse(uint32_t x){
+			x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+			x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+			x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+			x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+			return (x >> 16) | (x << 16);
+		}
+
+		/** Segment holding a bucket
+		 * @param[in] bucket index of the bucket
+		 * @param[out] segment index of its segment
+		*/
+		static unsigned segmentOf(uint32_t bucket){
+			return 0 == bucket ? 0 : 32 - __builtin_clz(bucket);
+		}
+
+		/** Slot of a bucket, its segment is allocated if needed
+		 * @param[in] bucket index of the bucket
+		 * @param[out] slot the atomic pointer to the dummy node of the bucket
+		*/
+		std::atomic<CounterNode*>& slotOf(uint32_t bucket){
+			unsigned segment = segmentOf(bucket);
+			std::atomic<CounterNode*>* slots = _segments[segment].load(std::memory_order_acquire);
+			if(nullptr == slots){
+				unsigned size = 0 == segment ? 1 : 1u << (segment - 1);
+				std::atomic<CounterNode*>* fresh = new std::atomic<CounterNode*>[size];
+				for(unsigned i = 0; i<size; ++i){
+					fresh[i].store(nullptr, std::memory_order_relaxed);
+				}
+				// another thread may have allocated the segment meanwhile
+				if(_segments[segment].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel)){
+					slots = fresh;
+				}
+				else {
+					delete[] fresh;
+				}
+			}
+			return slots[0 == segment ? 0 : bucket - (1u << (segment - 1))];
+		}
+
+		/** Find a node in the list, or the place where it should be
+		 * @param[in] start node to start from, its order must be lower than order
+		 * @param[in] order split order of the node to find
+		 * @param[in] key key of the node to find, for key nodes
+		 * @param[in] isKey true to find a key node, false to find a bucket
+		 * @param[in] prev set to the last node before the place of the node
+		 * @param[out] node the node found, nullptr if not here
+		*/
+		template <typename Q>
+		static CounterNode* search(CounterNode* start, uint32_t order, const Q &key, bool isKey, CounterNode* &prev){
+			prev = start;
+			CounterNode* cur = prev->next.load(std::memory_order_acquire);
+			while(nullptr != cur and cur->order <= order){
+				if(cur->order == order and (not isKey or key == cur->key)){
+					return cur;
+				}
+				prev = cur;
+				cur = cur->next.load(std::memory_order_acquire);
+			}
+			return nullptr;
+		}
+
+		/** Link a node into the list, unless an equal node is already there
+		 * @param[in] start node to start from, its order must be lower than the order of node
+		 * @param[in] node node to link
+		 * @param[in] isKey true for a key node, false for a bucket
+		 * @param[out] node the node now in the list : node, or the equal one found
+		*/
+		static CounterNode* link(CounterNode* start, CounterNode* node, bool isKey){
+			CounterNode* prev;
+			while(true){
+				CounterNode* found = search(start, node->order, node->key, isKey, prev);
+				if(nullptr != found) return found;
+				CounterNode* next = prev->next.load(std::memory_order_acquire);
+				// nodes of equal order are kept after each other : insert after the last one,
+				// unless one of them is equal, linked by another thread since the search
+				while(nullptr != next and next->order <= node->order){
+					if(next->order == node->order and (not isKey or node->key == next->key)){
+						return next;
+					}
+					prev = next;
+					next = prev->next.load(std::memory_order_acquire);
+				}
+				node->next.store(next, std::memory_order_relaxed);
+				if(prev->next.compare_exchange_weak(next, node, std::memory_order_release, std::memory_order_relaxed)){
+					return node;
+				}
+				// another node was linked after prev, search again from it
+				start = prev;
+			}
+		}
+
+		/** Dummy node of a bucket, made and linked if needed
+		 * @param[in] bucket index of the bucket
+		 * @param[out] node the dummy node of the bucket
+		*/
+		CounterNode* bucketNode(uint32_t bucket){
+			std::atomic<CounterNode*> &slot = slotOf(bucket);
+			CounterNode* node = slot.load(std::memory_order_acquire);
+			if(nullptr == node){
+				// a bucket is split from its parent, the same index without its highest bit
+				uint32_t parent = 0 == bucket ? 0 : bucket & ~(1u << (31 - __builtin_clz(bucket)));
+				CounterNode* dummy = new CounterNode(reverse(bucket));
+				node = link(bucketNode(parent), dummy, false);
+				if(node != dummy) delete dummy;
+				slot.store(node, std::memory_order_release);
+			}
+			return node;
+		}
+
+		/** Find the node of a key
+		 * @param[in] key a key
+		 * @param[in] hash hashcode of key
+		 * @param[out] node node of the key, nullptr if not here
+		*/
+		template <typename Q>
+		CounterNode* find(const Q &key, uint32_t hash){
+			CounterNode* prev;
+			uint32_t bucket = hash & (_bucketCount.load(std::memory_order_acquire) - 1);
+			return search(bucketNode(bucket), reverse(hash) | 1, key, true, prev);
+		}
+
+		/** Find the node of a key, or link a new one
+		 * @param[in] key a key
+		 * @param[in] count counter of the key if it is added
+		 * @param[in] inserted set to true if the key was added by this call, else false
+		 * @param[out] node node of the key
+		*/
+		template <typename Q>
+		CounterNode* findOrInsert(const Q &key, V count, bool &inserted){
+			uint32_t hash = (uint32_t)_hasher(key);
+			CounterNode* node = find(key, hash);
+			inserted = false;
+			if(nullptr == node){
+				uint32_t bucketCount = _bucketCount.load(std::memory_order_acquire);
+				CounterNode* fresh = new CounterNode(reverse(hash) | 1, K(key), count);
+				node = link(bucketNode(hash & (bucketCount - 1)), fresh, true);
+				if(node == fresh){
+					inserted = true;
+					// double the buckets if they hold too many keys
+					if(_size.fetch_add(1, std::memory_order_relaxed) + 1 > COUNTERLOADFACTOR*bucketCount and (1u << 31) > bucketCount){
+						_bucketCount.compare_exchange_strong(bucketCount, 2*bucketCount, std::memory_order_acq_rel);
+					}
+				}
+				else {
+					// another thread added the key meanwhile
+					delete fresh;
+				}
+			}
+			return node;
+		}
+
+	public:
+		/// type of the keys
+		typedef K key_type;
+		/// type of the counters
+		typedef V mapped_type;
+
+		/** Simple constructor
+		 * @param[in] hasher hash function of the map
+		*/
+		explicit LockFreeCounterMap(const H &hasher = H()):
+		_bucketCount(2),
+		_size(0),
+		_hasher(hasher)
+		{
+			for(unsigned s = 0; s<SEGMENTS; ++s){
+				_segments[s].store(nullptr, std::memory_order_relaxed);
+			}
+			// bucket 0 is the head of the list
+			slotOf(0).store(new CounterNode(0), std::memory_order_relaxed);
+		}
+
+		/// nodes are shared between threads, the map cannot be copied
+		LockFreeCounterMap(const LockFreeCounterMap<K,V,H> &other) = delete;
+
+		/// nodes are shared between threads, the map cannot be copied
+		LockFreeCounterMap<K,V,H>& operator=(const LockFreeCounterMap<K,V,H> &other) = delete;
+
+		/** Destructor, frees every node
+		 * No other thread may use the map anymore.
+		*/
+		~LockFreeCounterMap(){
+			CounterNode* node = slotOf(0).load(std::memory_order_relaxed);
+			while(nullptr != node){
+				CounterNode* next = node->next.load(std::memory_order_relaxed);
+				delete node;
+				node = next;
+			}
+			for(unsigned s = 0; s<SEGMENTS; ++s){
+				delete[] _segments[s].load(std::memory_order_relaxed);
+			}
+		}
+
+		/** Add to the counter of a key, the key is added if not here yet
+		 * @param[in] key a key, a K or any type comparable with K the hasher accepts
+		 * @param[in] delta value added to the counter
+		 * @param[out] count value of the counter after the addition
+		*/
+		template <typename Q>
+		V increment(const Q &key, V delta = 1){
+			bool inserted;
+			return increment(key, delta, inserted);
+		}
+
+		/** Add to the counter of a key, the key is added if not here yet
+		 * @param[in] key a key, a K or any type comparable with K the hasher accepts
+		 * @param[in] delta value added to the counter
+		 * @param[in] inserted set to true if the key was added by this call, else false
+		 * @param[out] count value of the counter after the addition
+		*/
+		template <typename Q>
+		V increment(const Q &key, V delta, bool &inserted){
+			CounterNode* node = findOrInsert(key, delta, inserted);
+			if(inserted) return delta;
+			return node->count.fetch_add(delta, std::memory_order_relaxed) + delta;
+		}
+
+		/** Set the counter of a key, the key is added if not here yet
+		 * @param[in] key a key, a K or any type comparable with K the hasher accepts
+		 * @param[in] value value of the counter
+		*/
+		template <typename Q>
+		void put(const Q &key, V value){
+			bool inserted;
+			CounterNode* node = findOrInsert(key, value, inserted);
+			if(not inserted) node->count.store(value, std::memory_order_relaxed);
+		}
+
+		/** Value of the counter of a key
+		 * @param[in] key a key
+		 * @param[out] count value of the counter, 0 if the key is not here
+		*/
+		template <typename Q>
+		V get(const Q &key){
+			CounterNode* node = find(key, (uint32_t)_hasher(key));
+			return nullptr == node ? 0 : node->count.load(std::memory_order_relaxed);
+		}
+
+		/** Do map contains key ?
+		 * @param[in] key key to find
+		 * @param[out] bool True if the key is here, else false
+		*/
+		template <typename Q>
+		bool contains(const Q &key){
+			return nullptr != find(key, (uint32_t)_hasher(key));
+		}
+
+		/** Number of keys
+		 * @param[out] size number of keys added
+		*/
+		unsigned size(){ return _size.load(std::memory_order_relaxed); }
+
+		/** Tests if no key was added
+		 * @param[out] bool true if no key in the map, else false
+		*/
+		bool isEmpty(){ return 0 == size(); }
+
+		/** Number of buckets
+		 * @param[out] count number of buckets keys are spread over
+		*/
+		unsigned capacity(){ return _bucketCount.load(std::memory_order_relaxed); }
+
+		/** How the keys are spread over the buckets
+		 * A bucket holds the keys following its dummy node in the list,
+		 * the keys of buckets not split yet are counted with their parent.
+		 * @param[out] stats statistics of the map
+		*/
+		TableStats stats(){
+			TableStats stats;
+			unsigned long probes = 0;
+			unsigned length = 0;
+			CounterNode* node = slotOf(0).load(std::memory_order_acquire);
+			for(node = node->next.load(std::memory_order_acquire); nullptr != node; node = node->next.load(std::memory_order_acquire)){
+				if(node->order & 1){
+					probes += ++length;
+					++stats.size;
+					if(stats.maxProbe < length) stats.maxProbe = length;
+				}
+				else {
+					stats.addBucket(length);
+					length = 0;
+				}
+			}
+			stats.addBucket(length);
+			stats.loadFactor = (float)stats.size/stats.buckets;
+			stats.meanProbe = 0 < stats.size ? (float)probes/stats.size : 0;
+			return stats;
+		}
+
+		/** Call a function on every key and its counter
+		 * Other threads may still add keys and increment counters meanwhile :
+		 * each counter is read once, keys added during the call may be missed.
+		 * @param[in] visit function called with a pair of a const reference
+		 * to each key and the value of its counter, as the pairs of the tables
+		*/
+		template <typename F>
+		void forEach(F visit){
+			CounterNode* node = slotOf(0).load(std::memory_order_acquire);
+			while(nullptr != node){
+				if(node->order & 1){
+					visit(pair<const K&,V>(node->key, node->count.load(std::memory_order_relaxed)));
+				}
+				node = node->next.load(std::memory_order_acquire);
+			}
+		}
+};
+
+/** \brief LockFreeCounterMap can be used by several threads at once
+*/
+template <typename K, typename V, typename H>
+struct ThreadSafe<LockFreeCounterMap<K,V,H>> : std::true_type {};
+
+/** \brief Does a table count with a single atomic addition (increment) ?
+ * value is true for LockFreeCounterMap, false for the other tables.
+*/
+template <typename T>
+struct AtomicCounters : std::false_type {};
+
+/** \brief LockFreeCounterMap counters are incremented with fetch_add
+*/
+template <typename K, typename V, typename H>
+struct AtomicCounters<LockFreeCounterMap<K,V,H>> : std::true_type {};
+
+#endif // LOCKFREECOUNTERMAP_HPP
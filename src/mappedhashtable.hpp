@@ -0,0 +1,370 @@
+/**
+ * @file mappedhashtable.hpp
+ *
+ * @section desc File description
+ *
+ * snapshots of string keyed hashtables written into a file, and a read-only
+ * hashtable answering lookups straight from the file mapped in memory
+ *
+ * A snapshot holds three sections after its header :
+ * - buckets : bucketCount+1 uint32_t, entries of bucket b are the entries
+ *   first[b] to first[b+1] (excluded)
+ * - entries, aligned on 8 bytes : the hashcode of the key, the offset and
+ *   length of the key into the pool, and the value, sorted by bucket
+ * - pool : the characters of the keys, one after the other
+ * Every position is an offset from the start of the file, so the file is
+ * used as it is once mapped. Integers are stored as the processor does,
+ * a snapshot is read on the kind of machine which wrote it.
+ *
+ * mmap is POSIX, this file only builds on UNIX systems.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef MAPPEDHASHTABLE_HPP
+#define MAPPEDHASHTABLE_HPP
+
+/// macro to define the version of the snapshots written
+#ifndef SNAPSHOTVERSION
+#define SNAPSHOTVERSION 1
+#endif
+
+// included files section
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hashtable.hpp"
+
+/** \brief First bytes of a snapshot file.
+*/
+struct SnapshotHeader {
+	char magic[8]; /** "GLOSSYHT" */
+	uint32_t version; /** version of the format, SNAPSHOTVERSION */
+	uint32_t valueSize; /** sizeof of the values */
+	uint64_t hasherCheck; /** hashcode of a fixed string, to check the hasher is the same */
+	uint64_t bucketCount; /** number of buckets, a power of two */
+	uint64_t entryCount; /** number of pairs */
+	uint64_t bucketsOffset; /** position of the buckets */
+	uint64_t entriesOffset; /** position of the entries */
+	uint64_t poolOffset; /** position of the characters of the keys */
+	uint64_t poolSize; /** number of characters of the keys */
+	uint64_t fileSize; /** size of the whole file */
+	uint64_t checksum; /** wyhash of the header, checksum excluded, and of every byte after it */
+};
+
+/** \brief A pair of a snapshot : the key is into the pool.
+*/
+template <typename V>
+struct SnapshotEntry {
+	uint64_t hash; /** hashcode of the key */
+	uint32_t keyOffset; /** position of the key into the pool */
+	uint32_t keyLength; /** number of characters of the key */
+	V value; /** value maped to the key */
+};
+
+/// bytes every snapshot starts with
+static const char SNAPSHOTMAGIC[8] = {'G','L','O','S','S','Y','H','T'};
+
+/** Hashcode checking that the hasher of a snapshot is the one used to read it
+ * @param[in] hasher hash function of the snapshot
+ * @param[out] check hashcode of a fixed string
+*/
+template <typename H>
+uint64_t hasherCheck(const H &hasher){
+	return hasher(std::string_view("glossygloss"));
+}
+
+/** Checksum of a snapshot : its header, checksum excluded, then every
+ * byte following the header
+ * @param[in] header header of the snapshot
+ * @param[in] body adress of the first byte after the header
+ * @param[in] size number of bytes after the header
+ * @param[out] checksum wyhash of the bytes
+*/
+inline uint64_t snapshotChecksum(const SnapshotHeader &header, const void* body, size_t size){
+	SnapshotHeader copy = header;
+	copy.checksum = 0;
+	return wyhash(body, size, wyhash(&copy, sizeof(copy), 0x736e617073686f74ull));
+}
+
+/** Write every pair of a table into a snapshot file
+ * Keys must be strings, or convert into std::string_view (e.g. InternedString),
+ * values must be trivially copyable. Any table with forEach can be saved :
+ * Hashtable, FlatHashtable or ConcurrentHashtable.
+ * @param[in] table the table to save
+ * @param[in] path path of the file, replaced if it exists
+ * @param[in] hasher hash function the snapshot will be read with
+ * @exception HashtableException threw if the file cannot be written
+*/
+template <typename H = WyHasher, typename T>
+void saveSnapshot(T &table, const string &path, const H &hasher = H()){
+	typedef typename T::mapped_type V;
+	static_assert(std::is_trivially_copyable<V>::value, "values of a snapshot must be trivially copyable");
+	// every pair, hashed, with its key copied into the pool
+	std::vector<SnapshotEntry<V>> pairs;
+	string pool;
+	table.forEach([&](const auto &stored){
+		std::string_view key(stored.first);
+		SnapshotEntry<V> entry;
+		std::memset(&entry, 0, sizeof(entry));
+		entry.hash = hasher(key);
+		entry.keyOffset = (uint32_t)pool.size();
+		entry.keyLength = (uint32_t)key.size();
+		entry.value = stored.second;
+		pool.append(key.data(), key.size());
+		pairs.push_back(entry);
+	});
+	if(UINT32_MAX < pool.size() or UINT32_MAX <= pairs.size()){
+		throw HashtableException("Table is too large for a snapshot!");
+	}
+	uint64_t bucketCount = 1;
+	while(bucketCount < pairs.size()) bucketCount *= 2;
+	// counting sort of the entries by bucket
+	std::vector<uint32_t> first(bucketCount+1, 0);
+	for(const SnapshotEntry<V> &entry : pairs){
+		++first[(entry.hash & (bucketCount-1)) + 1];
+	}
+	for(uint64_t b = 0; b<bucketCount; ++b){
+		first[b+1] += first[b];
+	}
+	std::vector<SnapshotEntry<V>> entries(pairs.size());
+	std::vector<uint32_t> next(first.begin(), first.end()-1);
+	for(const SnapshotEntry<V> &entry : pairs){
+		entries[next[entry.hash & (bucketCount-1)]++] = entry;
+	}
+	// sections, each one on 8 bytes
+	SnapshotHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, SNAPSHOTMAGIC, sizeof(header.magic));
+	header.version = SNAPSHOTVERSION;
+	header.valueSize = sizeof(V);
+	header.hasherCheck = hasherCheck(hasher);
+	header.bucketCount = bucketCount;
+	header.entryCount = entries.size();
+	header.bucketsOffset = sizeof(SnapshotHeader);
+	header.entriesOffset = (header.bucketsOffset + first.size()*sizeof(uint32_t) + 7)/8*8;
+	header.poolOffset = header.entriesOffset + entries.size()*sizeof(SnapshotEntry<V>);
+	header.poolSize = pool.size();
+	header.fileSize = header.poolOffset + pool.size();
+	// the body starts after the header, offsets are from the start of the file
+	string body(header.fileSize - sizeof(SnapshotHeader), '\0');
+	std::memcpy(&body[header.bucketsOffset - sizeof(SnapshotHeader)], first.data(), first.size()*sizeof(uint32_t));
+	if(not entries.empty()){
+		std::memcpy(&body[header.entriesOffset - sizeof(SnapshotHeader)], entries.data(), entries.size()*sizeof(SnapshotEntry<V>));
+	}
+	if(not pool.empty()){
+		std::memcpy(&body[header.poolOffset - sizeof(SnapshotHeader)], pool.data(), pool.size());
+	}
+	header.checksum = snapshotChecksum(header, body.data(), body.size());
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(body.data(), body.size());
+	file.close();
+	if(not file) throw HashtableException("Snapshot cannot be written!");
+}
+
+/** \brief Read-only hashtable mapping a snapshot file in memory.
+ *
+ * Opening a snapshot maps the file and checks its header and checksum,
+ * nothing is rehashed nor allocated : lookups read the buckets, entries
+ * and keys where they are into the file. Keys are looked up as
+ * std::string_view, values are read only.
+*/
+template <typename V, typename H = WyHasher>
+class MappedHashtable {
+
+	private:
+		const char* _data; /** first byte of the mapped file */
+		size_t _fileSize; /** number of bytes mapped */
+		const SnapshotHeader* _header; /** header of the snapshot */
+		const uint32_t* _buckets; /** first entry of each bucket */
+		const SnapshotEntry<V>* _entries; /** entries sorted by bucket */
+		const char* _pool; /** characters of the keys */
+		H _hasher; /** computes hashcodes of keys, as the one which wrote the snapshot */
+
+		/** Unmap the file and throw an exception
+		 * @param[in] message message of the exception
+		 * @exception HashtableException always threw
+		*/
+		void fail(const char* message){
+			if(nullptr != _data) munmap(const_cast<char*>(_data), _fileSize);
+			_data = nullptr;
+			throw HashtableException(message);
+		}
+
+		/** Check that the file is a snapshot this table can read
+		 * @exception HashtableException threw if the file is not a valid snapshot
+		*/
+		void check(){
+			if(sizeof(SnapshotHeader) > _fileSize) fail("Snapshot is truncated!");
+			if(0 != std::memcmp(_header->magic, SNAPSHOTMAGIC, sizeof(SNAPSHOTMAGIC))) fail("File is not a snapshot!");
+			if(SNAPSHOTVERSION != _header->version) fail("Snapshot version is not supported!");
+			if(sizeof(V) != _header->valueSize) fail("Snapshot values have another type!");
+			if(hasherCheck(_hasher) != _header->hasherCheck) fail("Snapshot was written with another hasher!");
+			if(_fileSize != _header->fileSize) fail("Snapshot is truncated!");
+			const SnapshotHeader &h = *_header;
+			if(snapshotChecksum(h, _data + sizeof(SnapshotHeader), _fileSize - sizeof(SnapshotHeader)) != h.checksum){
+				fail("Snapshot checksum does not match!");
+			}
+			// counts are bounded first, so computing the sections cannot overflow
+			if(h.bucketCount > _fileSize or h.entryCount > _fileSize
+			   or 0 == h.bucketCount or 0 != (h.bucketCount & (h.bucketCount-1))
+			   or sizeof(SnapshotHeader) > h.bucketsOffset or 0 != h.bucketsOffset % 4
+			   or h.bucketsOffset + (h.bucketCount+1)*sizeof(uint32_t) > h.entriesOffset
+			   or 0 != h.entriesOffset % 8
+			   or h.entriesOffset + h.entryCount*sizeof(SnapshotEntry<V>) != h.poolOffset
+			   or h.poolOffset + h.poolSize != h.fileSize){
+				fail("Snapshot sections are corrupted!");
+			}
+			// buckets are checked once here, so find reads no entry nor character out of the file
+			const uint32_t* buckets = reinterpret_cast<const uint32_t*>(_data + h.bucketsOffset);
+			if(0 != buckets[0] or h.entryCount != buckets[h.bucketCount]){
+				fail("Snapshot buckets are corrupted!");
+			}
+			for(uint64_t b = 0; b<h.bucketCount; ++b){
+				if(buckets[b] > buckets[b+1]) fail("Snapshot buckets are corrupted!");
+			}
+			const SnapshotEntry<V>* entries = reinterpret_cast<const SnapshotEntry<V>*>(_data + h.entriesOffset);
+			for(uint64_t i = 0; i<h.entryCount; ++i){
+				if((uint64_t)entries[i].keyOffset + entries[i].keyLength > h.poolSize){
+					fail("Snapshot keys are corrupted!");
+				}
+			}
+		}
+
+		/** Find the entry of a key
+		 * @param[in] key key to find
+		 * @param[out] entry the entry of key, nullptr if key is not here
+		*/
+		const SnapshotEntry<V>* find(std::string_view key) const {
+			uint64_t hash = _hasher(key);
+			uint64_t bucket = hash & (_header->bucketCount-1);
+			for(uint32_t i = _buckets[bucket]; i<_buckets[bucket+1]; ++i){
+				const SnapshotEntry<V> &entry = _entries[i];
+				if(hash == entry.hash and key.size() == entry.keyLength
+				   and 0 == std::memcmp(_pool + entry.keyOffset, key.data(), key.size())){
+					return &entry;
+				}
+			}
+			return nullptr;
+		}
+
+	public:
+		/** Constructor, maps a snapshot written by saveSnapshot
+		 * @param[in] path path of the snapshot file
+		 * @param[in] hasher hash function the snapshot was written with
+		 * @exception HashtableException threw if the file cannot be read or is not a valid snapshot
+		*/
+		explicit MappedHashtable(const string &path, const H &hasher = H()):
+		_data(nullptr),
+		_fileSize(0),
+		_hasher(hasher)
+		{
+			int fd = open(path.c_str(), O_RDONLY);
+			if(0 > fd) throw HashtableException("Snapshot cannot be opened!");
+			struct stat info;
+			if(0 != fstat(fd, &info) or 0 == info.st_size){
+				close(fd);
+				throw HashtableException("Snapshot is truncated!");
+			}
+			_fileSize = info.st_size;
+			void* mapped = mmap(nullptr, _fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if(MAP_FAILED == mapped) throw HashtableException("Snapshot cannot be mapped!");
+			_data = static_cast<const char*>(mapped);
+			_header = reinterpret_cast<const SnapshotHeader*>(_data);
+			check();
+			_buckets = reinterpret_cast<const uint32_t*>(_data + _header->bucketsOffset);
+			_entries = reinterpret_cast<const SnapshotEntry<V>*>(_data + _header->entriesOffset);
+			_pool = _data + _header->poolOffset;
+		}
+
+		/// the mapping is owned by the table, it cannot be copied
+		MappedHashtable(const MappedHashtable<V,H> &other) = delete;
+
+		/// the mapping is owned by the table, it cannot be copied
+		MappedHashtable<V,H>& operator=(const MappedHashtable<V,H> &other) = delete;
+
+		/** Destructor, unmaps the file
+		*/
+		~MappedHashtable(){
+			if(nullptr != _data) munmap(const_cast<char*>(_data), _fileSize);
+		}
+
+		/** Do table contains key ?
+		 * @param[in] key key to find
+		 * @param[out] bool True if the key is here, else false
+		*/
+		bool contains(std::string_view key) const {
+			return nullptr != find(key);
+		}
+
+		/** Return the value maped to the specified key
+		 * @param[in] key a key in the hashtable
+		 * @param[out] value value associated with the key, into the mapped file
+		 * @exception HashtableException threw if key is not in the hashtable
+		*/
+		const V& get(std::string_view key) const {
+			const SnapshotEntry<V>* entry = find(key);
+			if(nullptr == entry) throw HashtableException("Key not found!");
+			return entry->value;
+		}
+
+		/** Tests if this hashtable maps no keys to values.
+		 * @param[out] bool true if no elements in the hashtable, else false;
+		*/
+		bool isEmpty() const { return 0 == _header->entryCount; }
+
+		/** Number of pairs stored in the hashtable
+		 * @param[out] size number of keys
+		*/
+		unsigned size() const { return (unsigned)_header->entryCount; }
+
+		/** Number of buckets of the hashtable
+		 * @param[out] capacity number of buckets
+		*/
+		unsigned capacity() const { return (unsigned)_header->bucketCount; }
+
+		/** Call a function on every pair
+		 * @param[in] visit function called with the key, as a string_view, and a const reference to the value
+		*/
+		template <typename F>
+		void forEach(F visit) const {
+			for(uint64_t i = 0; i<_header->entryCount; ++i){
+				visit(std::string_view(_pool + _entries[i].keyOffset, _entries[i].keyLength), _entries[i].value);
+			}
+		}
+};
+
+#endif // MAPPEDHASHTABLE_HPP
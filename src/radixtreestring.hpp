@@ -0,0 +1,334 @@
+/**
+ * @file radixtreestring.hpp
+ *
+ * @section desc File description
+ *
+ * RadixTreeString is a path-compressed TreeString : a chain of letters
+ * with a single child each is stored in one node, as a fragment of word
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+ */
+
+#ifndef RADIXTREESTRING_HPP
+#define RADIXTREESTRING_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <forward_list>
+#include <utility>
+#include <string_view>
+#include "treestring.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::forward_list;
+using std::pair;
+
+/** \brief Node of a RadixTreeString.
+ *
+ * A RadixNode stores a fragment of word, at least one letter except for
+ * the root. Fragments are kept by the tree, a node only knows where its
+ * fragment starts and its length. Children are indexed by the first
+ * letter of their fragment.
+ */
+class RadixNode {
+
+	private:
+		/// position of the fragment in the letters of the tree
+		uint32_t _offset;
+		/// number of letters of the fragment
+		uint32_t _length;
+		/// frequency of the word ending with this node, 0 if none
+		int _wordFrequency;
+		/// indexes of the children of the node, by first letter of their fragment
+		NodeChildren<uint32_t> _children;
+
+	public:
+		/** Simple constructor
+		 * @param[in] offset position of the fragment in the letters of the tree
+		 * @param[in] length number of letters of the fragment
+		 * @param[in] frequency frequency of the word ending with the node
+		 */
+		RadixNode(uint32_t offset, uint32_t length, int frequency):
+		_offset(offset),
+		_length(length),
+		_wordFrequency(frequency)
+		{}
+
+		/** Empty constructor, the root of a tree
+		 */
+		RadixNode():
+		_offset(0),
+		_length(0),
+		_wordFrequency(0)
+		{}
+
+		/** Position of the fragment in the letters of the tree
+		 * @param[out] offset position of the first letter
+		 */
+		uint32_t getOffset() const { return _offset; }
+
+		/** Number of letters of the fragment
+		 * @param[out] length number of letters
+		 */
+		uint32_t getLength() const { return _length; }
+
+		/** Remove the first letters of the fragment
+		 * @param[in] count number of letters to remove
+		 */
+		void cut(uint32_t count){
+			_offset += count;
+			_length -= count;
+		}
+
+		/** How many times the word ending with this node was added ?
+		 * @param[out] frequency frequency of the word, 0 if no word ends here
+		 */
+		int getFrequency() const { return _wordFrequency; }
+
+		/** Count the word ending with this node again
+		 * @param[in] frequency frequency to add
+		 */
+		void addFrequency(int frequency){ _wordFrequency += frequency; }
+
+		/** Children of the node
+		 * @param[out] children indexes of the children, by first letter
+		 */
+		NodeChildren<uint32_t>& children(){ return _children; }
+
+		/** Children of the node
+		 * @param[out] children indexes of the children, by first letter
+		 */
+		const NodeChildren<uint32_t>& children() const { return _children; }
+};
+
+/** \brief Path-compressed tree of words.
+ *
+ * Same interface as TreeString, but letters followed by a single child
+ * are merged into one node : a vocabulary takes far fewer nodes, and
+ * a lookup follows a few nodes then compares their fragments.
+ * As for TreeString, nodes are stored in a vector and linked by index,
+ * and the fragments are slices of a single string of letters.
+ */
+class RadixTreeString {
+
+	private:
+		vector<RadixNode> _nodes; /** nodes of the tree, the root first */
+		ChildBlocks<uint32_t> _blocks; /** blocks of children of the nodes */
+		string _letters; /** letters of the fragments */
+
+		/// index of the root, never a child so 0 also means no child
+		static constexpr uint32_t ROOT = 0;
+
+		/** Fragment of a node
+		 * @param[in] node index of the node
+		 * @param[out] fragment letters from the parent to the node
+		 */
+		string_view fragmentOf(uint32_t node) const {
+			return string_view(_letters).substr(_nodes[node].getOffset(), _nodes[node].getLength());
+		}
+
+		/** The height of a node, in nodes
+		 * @param[in] node index of the node
+		 * @param[out] hgt height of the node
+		 */
+		int height(uint32_t node) const {
+			int hgt = 0;
+			_nodes[node].children().forEach([this, &hgt](uint32_t child){
+				int childHeight = 1 + height(child);
+				if(hgt < childHeight) hgt = childHeight;
+			}, _blocks);
+			return hgt;
+		}
+
+	public:
+		/** Default constructor
+		 */
+		RadixTreeString():
+			_nodes(1, RadixNode())
+			{}
+
+		/** The height of the tree, in nodes
+		 * @param[out] hgt Height of the tree
+		 */
+		int height() const {
+			return height(ROOT);
+		}
+
+		/** Number of nodes of the tree, the root included
+		 * @param[out] count number of nodes
+		 */
+		size_t nodeCount() const {
+			return _nodes.size();
+		}
+
+		/** Put a word in the tree
+		 * The common prefix of the word and of a fragment is split from it,
+		 * so the word ends on a node.
+		 * @param[in] word New element to put into the tree
+		 * @param[out] frequency frequency of the word afterwards, 1 if it is new
+		 */
+		int put(string_view word){
+			// an empty word has no last letter to count it
+			if(word.empty()) return 0;
+			uint32_t current = ROOT;
+			while(not word.empty()){
+				uint32_t next = _nodes[current].children().find(word[0], _blocks);
+				// no fragment starts like the word, the end of the word is a new leaf
+				if(ROOT == next){
+					next = (uint32_t)_nodes.size();
+					_nodes.push_back(RadixNode((uint32_t)_letters.size(), (uint32_t)word.size(), 1));
+					_letters.append(word);
+					_nodes[current].children().insert(word[0], next, _blocks);
+					return 1;
+				}
+				string_view fragment = fragmentOf(next);
+				size_t common = 1;
+				size_t length = fragment.size() < word.size() ? fragment.size() : word.size();
+				while(common < length and fragment[common] == word[common]){
+					++common;
+				}
+				// the word leaves the fragment, split it
+				if(common < fragment.size()){
+					uint32_t middle = (uint32_t)_nodes.size();
+					_nodes.push_back(RadixNode(_nodes[next].getOffset(), (uint32_t)common, 0));
+					_nodes[next].cut((uint32_t)common);
+					_nodes[middle].children().insert(fragment[common], next, _blocks);
+					_nodes[current].children().replace(word[0], middle, _blocks);
+					next = middle;
+				}
+				current = next;
+				word.remove_prefix(common);
+			}
+			_nodes[current].addFrequency(1);
+			return _nodes[current].getFrequency();
+		}
+
+		/** Is a word in the tree ?
+		 * @param[in] word the word to look for
+		 * @param[out] bool true if the word was put, else false
+		 */
+		bool contains(string_view word) const {
+			return 0 < frequency(word);
+		}
+
+		/** How many times a word was put in the tree
+		 * @param[in] word the word to look for
+		 * @param[out] frequency number of times the word was put, 0 if absent
+		 */
+		int frequency(string_view word) const {
+			if(word.empty()) return 0;
+			uint32_t current = ROOT;
+			while(not word.empty()){
+				current = _nodes[current].children().find(word[0], _blocks);
+				if(ROOT == current) return 0;
+				string_view fragment = fragmentOf(current);
+				if(word.size() < fragment.size() or word.substr(0, fragment.size()) != fragment){
+					return 0;
+				}
+				word.remove_prefix(fragment.size());
+			}
+			return _nodes[current].getFrequency();
+		}
+
+		/** Put each word in a list
+		 * The list must be initialized !
+		 * @param[in] list List containing string for each word stored in Tree
+		 */
+		void getWords(forward_list<string> &list) const {
+			forEachWord([&list](string_view word, int){
+				list.push_front(string(word));
+			});
+		}
+
+		/** Get a list of all words stored in Tree and
+		 * their frequencies, i.e. how times a word was added
+		 * @param[int] list List of pair containing for each word in Tree
+		 * his frequency
+		 */
+		void getWordsFrequencies(forward_list<pair<string,int>> &words) const {
+			forEachWord([&words](string_view word, int frequency){
+				words.push_front(pair<string,int>(string(word), frequency));
+			});
+		}
+
+		/** Call a function on every word starting with a prefix, in
+		 * increasing order of their letters as unsigned chars
+		 * The tree is walked with a stack of nodes and a single buffer
+		 * holding the current word, nothing is allocated for each word.
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[in] visit function called with each word, as a string_view
+		 * valid during the call only, and its frequency
+		 */
+		template <typename F>
+		void forEachWord(string_view prefix, F visit) const {
+			uint32_t start = ROOT;
+			string word;
+			// the prefix may end inside the fragment of start
+			while(word.size() < prefix.size()){
+				start = _nodes[start].children().find(prefix[word.size()], _blocks);
+				if(ROOT == start) return;
+				string_view fragment = fragmentOf(start);
+				string_view rest = prefix.substr(word.size(), fragment.size());
+				if(rest != fragment.substr(0, rest.size())) return;
+				word += fragment;
+			}
+			if(0 < _nodes[start].getFrequency()) visit(string_view(word), _nodes[start].getFrequency());
+			// nodes to visit, with the length of the word before their fragment
+			vector<pair<uint32_t,size_t>> stack;
+			auto pushChildren = [this, &stack, &word](uint32_t node){
+				size_t first = stack.size();
+				_nodes[node].children().forEach([&stack, &word](uint32_t child){
+					stack.push_back(pair<uint32_t,size_t>(child, word.size()));
+				}, _blocks);
+				// children come by increasing first letter, the least one must be on top
+				std::reverse(stack.begin() + first, stack.end());
+			};
+			pushChildren(start);
+			while(not stack.empty()){
+				pair<uint32_t,size_t> top = stack.back();
+				stack.pop_back();
+				word.resize(top.second);
+				word += fragmentOf(top.first);
+				if(0 < _nodes[top.first].getFrequency()) visit(string_view(word), _nodes[top.first].getFrequency());
+				pushChildren(top.first);
+			}
+		}
+
+		/** Call a function on every word, in increasing order
+		 * @param[in] visit function called with each word, as a string_view
+		 * valid during the call only, and its frequency
+		 */
+		template <typename F>
+		void forEachWord(F visit) const {
+			forEachWord(string_view(), visit);
+		}
+};
+
+#endif // RADIXTREESTRING_HPP
@@ -0,0 +1,126 @@
+/**
+ * @file sample_counters.cpp
+ *
+ * @section desc File description
+ *
+ * a sample of LockFreeCounterMap usages : the words of a file are
+ * counted by several threads at once, without any lock.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+
+#include <iostream>
+#include <cstdlib> // nécessaire pour utilisation atoi
+#include <fstream> // Permet de lire et enregistrer des données dans un fichier
+#include <thread>
+#include <vector>
+#include <set>
+#include "lockfreecountermap.hpp"
+
+using namespace std;
+
+int main(int argc,const char** argv){
+
+	if(argc != 3){
+		perror("Bad arguments!");
+		exit(1);
+	}
+
+	vector<string> words;
+	fstream file;
+	string word;
+	file.open(argv[1], ios::in);
+	while(file >> word){
+		words.push_back(word);
+	}
+	file.close();
+
+	unsigned nbThreads = atoi(argv[2]);
+	if(0 == nbThreads) nbThreads = 1;
+
+	LockFreeCounterMap<string,long> counters;
+	vector<thread> threads;
+	size_t part = (words.size() + nbThreads - 1)/nbThreads;
+	for(unsigned t = 0; t<nbThreads; ++t){
+		// each thread counts a contiguous slice of the words,
+		// frequent words are incremented by every thread at once
+		size_t begin = t*part < words.size() ? t*part : words.size();
+		size_t end = begin + part < words.size() ? begin + part : words.size();
+		threads.emplace_back([&counters, &words, begin, end](){
+			for(size_t i = begin; i<end; ++i){
+				counters.increment(words[i]);
+			}
+		});
+	}
+	for(thread &worker : threads){
+		worker.join();
+	}
+
+	// no thread uses the map anymore, every counter is final
+	long total = 0;
+	pair<string,long> best("", 0);
+	counters.forEach([&total, &best](const auto &counter){
+		total += counter.second;
+		if(best.second < counter.second) best = pair<string,long>(counter.first, counter.second);
+	});
+	cout << words.size() << " words read, " << total << " counted by " << nbThreads << " threads" << endl;
+	cout << counters.size() << " different words, the most frequent is "
+	     << best.first << " (" << best.second << ")" << endl;
+	cout << counters.stats().toString();
+
+	// every thread adds every different word at once : each word must be
+	// linked once, whatever thread wins, and counted once by each thread
+	set<string> different(words.begin(), words.end());
+	vector<string> keys(different.begin(), different.end());
+	LockFreeCounterMap<string,long> racing;
+	threads.clear();
+	for(unsigned t = 0; t<nbThreads; ++t){
+		threads.emplace_back([&racing, &keys](){
+			for(const string &key : keys){
+				racing.increment(key);
+			}
+		});
+	}
+	for(thread &worker : threads){
+		worker.join();
+	}
+	unsigned wrong = 0;
+	racing.forEach([&wrong, nbThreads](const auto &counter){
+		if((long)nbThreads != counter.second) ++wrong;
+	});
+	if(keys.size() != counters.size() or keys.size() != racing.size() or 0 != wrong){
+		cout << "Duplicated keys! " << keys.size() << " different words, " << counters.size()
+		     << " and " << racing.size() << " keys, " << wrong << " wrong counters" << endl;
+		return 1;
+	}
+	cout << "No duplicated key, " << keys.size() << " words added by " << nbThreads << " threads at once" << endl;
+	cout << "Give a word to get its count" << endl;
+	string reader;
+	if(cin >> reader){
+		cout << reader << " counted " << counters.get(reader) << " times" << endl;
+	}
+	return 0;
+}
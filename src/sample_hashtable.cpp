@@ -42,14 +42,6 @@
 
 using namespace std;
 
-
-template<> unsigned computehash<K>(K element){
-	// calcul de la clé de hachage en utilisant fonction fournie par API
-	hash<K> hashcalculator;
-	return hashcalculator(element);
-}
-
-
 int main(int argc,const char** argv){
 
 	if(argc != 4){
@@ -0,0 +1,181 @@
+/**
+ * @file slaballocator.hpp
+ *
+ * @section desc File description
+ *
+ * allocators handing out memory for one object at a time, used by
+ * containers to allocate their elements (e.g. Hashtable alveoles)
+ *
+ * An allocator policy provides :
+ * - T* allocate() : memory for one T, not constructed
+ * - void deallocate(T* ptr) : give back memory from allocate, T already destroyed
+ * - void release() : give back all the memory at once, objects already destroyed
+ * - static const bool bulkRelease : if true, release() frees every object
+ *   so deallocate() does not need to be called before it
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef SLABALLOCATOR_HPP
+#define SLABALLOCATOR_HPP
+
+/// macro to define the number of objects in each slab
+#ifndef SLABSIZE
+#define SLABSIZE 256
+#endif
+
+// included files section
+#include <new>
+
+/** \brief Allocates each object on its own with new and delete.
+*/
+template <typename T>
+class HeapAllocator {
+	public:
+		/// objects must be deallocated one by one
+		static const bool bulkRelease = false;
+
+		/** Memory for one object
+		 * @param[out] ptr adress of memory for a T, not constructed
+		*/
+		T* allocate(){
+			return static_cast<T*>(::operator new(sizeof(T)));
+		}
+
+		/** Give back memory of one object
+		 * @param[in] ptr adress given by allocate, object already destroyed
+		*/
+		void deallocate(T* ptr){
+			::operator delete(ptr);
+		}
+
+		/** Nothing to do, each object was given back by deallocate
+		*/
+		void release(){}
+};
+
+/** \brief Allocates objects from contiguous slabs of SLABSIZE objects.
+ *
+ * Freed objects are kept in a free list and given again by allocate before
+ * the current slab is used further. Slabs are only freed by release, or when
+ * the allocator is destroyed, all at once.
+*/
+template <typename T>
+class SlabAllocator {
+	private:
+		/** \brief A place for one object, or a link of the free list */
+		union Cell {
+			Cell* next; /** next free cell */
+			alignas(T) unsigned char storage[sizeof(T)]; /** memory of the object */
+		};
+
+		/** \brief SLABSIZE cells allocated at once */
+		struct Slab {
+			Slab* next; /** previous slab allocated */
+			Cell cells[SLABSIZE]; /** cells of the slab */
+		};
+
+		Slab* _slabs; /** last slab allocated, nullptr if none */
+		unsigned _used; /** number of cells of the last slab already given */
+		Cell* _free; /** first cell of the free list, nullptr if empty */
+
+	public:
+		/// release() frees every object, no need to deallocate them first
+		static const bool bulkRelease = true;
+
+		/** Simple constructor
+		 * no memory is allocated before the first object
+		*/
+		SlabAllocator():
+		_slabs(nullptr),
+		_used(SLABSIZE),
+		_free(nullptr)
+		{}
+
+		/** Copy constructor
+		 * Memory is not shared, the copy starts without slab.
+		*/
+		SlabAllocator(const SlabAllocator<T> &):
+		SlabAllocator()
+		{}
+
+		/** Destructor, frees all the slabs
+		*/
+		~SlabAllocator(){
+			release();
+		}
+
+		/** assignment operator overload
+		 * Memory is not shared, the slabs are kept.
+		*/
+		SlabAllocator<T>& operator=(const SlabAllocator<T> &){
+			return (*this);
+		}
+
+		/** Memory for one object
+		 * @param[out] ptr adress of memory for a T, not constructed
+		*/
+		T* allocate(){
+			Cell* cell;
+			if(nullptr != _free){
+				cell = _free;
+				_free = _free->next;
+			}
+			else {
+				if(SLABSIZE == _used){
+					Slab* slab = new Slab;
+					slab->next = _slabs;
+					_slabs = slab;
+					_used = 0;
+				}
+				cell = &_slabs->cells[_used++];
+			}
+			return reinterpret_cast<T*>(cell->storage);
+		}
+
+		/** Give back memory of one object, put it in the free list
+		 * @param[in] ptr adress given by allocate, object already destroyed
+		*/
+		void deallocate(T* ptr){
+			Cell* cell = reinterpret_cast<Cell*>(ptr);
+			cell->next = _free;
+			_free = cell;
+		}
+
+		/** Free all the slabs at once
+		 * Objects must have been destroyed before.
+		*/
+		void release(){
+			while(nullptr != _slabs){
+				Slab* slab = _slabs;
+				_slabs = slab->next;
+				delete slab;
+			}
+			_used = SLABSIZE;
+			_free = nullptr;
+		}
+};
+
+#endif // SLABALLOCATOR_HPP
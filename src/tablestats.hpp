@@ -0,0 +1,157 @@
+/**
+ * @file tablestats.hpp
+ *
+ * @section desc File description
+ *
+ * statistics of hashtables : how pairs are spread over the buckets, and
+ * optional counters of what the table did since it was made
+ *
+ * Define HASHTABLE_STATS before including the tables to count hits,
+ * misses, key compares and allocations. Without it, counting compiles
+ * to nothing and the counters stay at zero.
+ *
+ * @section copyright Copyright
+ *
+ * This source code is protected by the French intellectual property law.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * @section infos File informations
+ *
+ * $Date$ 2026/10/17
+ * $Rev$ 0.1
+ * $Author$ Benjamin Sientzoff
+ * $URL$ http://www.github.com/blasterbug
+*/
+#ifndef TABLESTATS_HPP
+#define TABLESTATS_HPP
+
+/// macro to count an event into the _counters member of a table
+#ifdef HASHTABLE_STATS
+#define TABLECOUNT(counter, n) (_counters.counter += (n))
+#else
+#define TABLECOUNT(counter, n) ((void)0)
+#endif
+
+// included files section
+#include <string>
+#include <vector>
+
+/** \brief What a table did since it was made, counted only if
+ * HASHTABLE_STATS is defined.
+*/
+struct TableCounters {
+	unsigned long hits; /** lookups which found their key */
+	unsigned long misses; /** lookups which did not find their key */
+	unsigned long compares; /** stored keys compared with a looked up key */
+	unsigned long allocations; /** memory allocations, of alveoles or arrays of slots */
+
+	/** Simple constructor, every counter at zero
+	*/
+	TableCounters():
+	hits(0),
+	misses(0),
+	compares(0),
+	allocations(0)
+	{}
+
+	/** Add the counters of another table
+	 * @param[in] other counters to add
+	 * @param[out] counters these counters
+	*/
+	TableCounters& operator+=(const TableCounters &other){
+		hits += other.hits;
+		misses += other.misses;
+		compares += other.compares;
+		allocations += other.allocations;
+		return (*this);
+	}
+};
+
+/** \brief How the pairs of a table are spread over its buckets.
+ *
+ * For a FlatHashtable, a bucket is a group of slots and the probe length
+ * of a key is the number of groups browsed to find it. For a Hashtable,
+ * the probe length of a key is its position in its chain.
+*/
+struct TableStats {
+	unsigned size; /** number of pairs */
+	unsigned buckets; /** number of buckets */
+	float loadFactor; /** average number of pairs per bucket, or per slot for a FlatHashtable */
+	std::vector<unsigned> chains; /** chains[n] is the number of buckets holding n pairs */
+	unsigned maxProbe; /** longest probe length of a key */
+	float meanProbe; /** average probe length of the keys */
+	TableCounters counters; /** what the table did, zero if HASHTABLE_STATS is not defined */
+
+	/** Simple constructor, statistics of an empty table
+	*/
+	TableStats():
+	size(0),
+	buckets(0),
+	loadFactor(0),
+	maxProbe(0),
+	meanProbe(0)
+	{}
+
+	/** Count a bucket holding n pairs into the histogram
+	 * @param[in] n number of pairs of the bucket
+	*/
+	void addBucket(unsigned n){
+		if(chains.size() <= n) chains.resize(n+1, 0);
+		++chains[n];
+		++buckets;
+	}
+
+	/** Add the statistics of another table, as if both were one table
+	 * @param[in] other statistics to add
+	*/
+	void merge(const TableStats &other){
+		if(0 < size + other.size){
+			meanProbe = (meanProbe*size + other.meanProbe*other.size)/(size + other.size);
+		}
+		size += other.size;
+		buckets += other.buckets;
+		loadFactor = 0 < buckets ? (float)size/buckets : 0;
+		if(chains.size() < other.chains.size()) chains.resize(other.chains.size(), 0);
+		for(unsigned n = 0; n<other.chains.size(); ++n){
+			chains[n] += other.chains[n];
+		}
+		if(maxProbe < other.maxProbe) maxProbe = other.maxProbe;
+		counters += other.counters;
+	}
+
+	/** Return a description of the statistics, one per line
+	 * @param[out] desc a string representation of the statistics
+	*/
+	std::string toString() const {
+		std::string desc = "size: " + std::to_string(size)
+			+ "\nbuckets: " + std::to_string(buckets)
+			+ "\nload factor: " + std::to_string(loadFactor)
+			+ "\nprobe length: max " + std::to_string(maxProbe) + ", mean " + std::to_string(meanProbe)
+			+ "\nchain lengths:";
+		for(unsigned n = 0; n<chains.size(); ++n){
+			if(0 < chains[n]) desc += " " + std::to_string(n) + ":" + std::to_string(chains[n]);
+		}
+#ifdef HASHTABLE_STATS
+		desc += "\nhits: " + std::to_string(counters.hits)
+			+ "\nmisses: " + std::to_string(counters.misses)
+			+ "\ncompares: " + std::to_string(counters.compares)
+			+ "\nallocations: " + std::to_string(counters.allocations);
+#endif
+		return desc + "\n";
+	}
+};
+
+#endif // TABLESTATS_HPP
@@ -37,14 +37,34 @@
 
 #include <cassert>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <queue>
+#include <tuple>
+#include <algorithm>
 #include <forward_list>
 #include <utility>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+/// macro to define the length of the longest word whose nodes TreeString::put
+/// remembers, the nodes of longer words are found again
+#ifndef TREEPATH
+#define TREEPATH 32
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using std::string;
+using std::vector;
 using std::forward_list;
 using std::stringstream;
 using std::pair;
+using std::string_view;
 
 /** \brief exception class for trees
  * useless
@@ -52,13 +72,13 @@ using std::pair;
  */
 class TreeStringException : std::exception {
 	private:
-		char* _cause; /** store exception description */
+		const char* _cause; /** store exception description */
 	public:
 		/** constructor
 		 * called then TreeExceptions are threw
 		 * @param[in] cause description of exception origin
 		 */
-		TreeStringException(char* cause):
+		TreeStringException(const char* cause):
 			_cause(cause)
 			{}
 		
@@ -77,81 +97,358 @@ class TreeStringException : std::exception {
 		}
 };
 
+
+/** \brief Blocks of children of the nodes of a tree, one pool per kind.
+ * 
+ * The pools belong to the tree, so copying them with the nodes copies
+ * the tree, and they are freed at once with it. A block is referenced
+ * by its index in its pool. Blocks left by nodes growing to a greater
+ * kind are reused.
+ */
+template <typename C>
+class ChildBlocks {
+
+	public:
+		/** \brief up to 16 children, sorted by tag */
+		struct Block16 {
+			unsigned char tags[16]; /** tags of the children */
+			C children[16]; /** children */
+		};
+
+		/** \brief up to 48 children, found by tag */
+		struct Block48 {
+			unsigned char slots[256]; /** slot of each tag plus one, 0 if no child */
+			C children[48]; /** children, in insertion order */
+		};
+
+		/** \brief a child for each tag */
+		struct Block256 {
+			C children[256]; /** child of each tag, C() if none */
+		};
+
+		vector<Block16> medium; /** blocks of 16 children */
+		vector<Block48> large; /** blocks of 48 children */
+		vector<Block256> full; /** blocks of 256 children */
+		vector<uint32_t> freeMedium; /** indexes of unused blocks of 16 children */
+		vector<uint32_t> freeLarge; /** indexes of unused blocks of 48 children */
+
+		/** Take a block from a pool, an unused one if any
+		 * @param[in] pool pool of blocks
+		 * @param[in] freed unused blocks of the pool
+		 * @param[out] block index of the block
+		 */
+		template <typename B>
+		static uint32_t take(vector<B> &pool, vector<uint32_t> &freed){
+			if(not freed.empty()){
+				uint32_t block = freed.back();
+				freed.pop_back();
+				return block;
+			}
+			pool.push_back(B());
+			return (uint32_t)(pool.size()-1);
+		}
+
+		/** Copy the blocks of another tree after the blocks of this one
+		 * The nodes of the other tree are copied too, so its children are
+		 * shifted by an offset. Blocks of a pool are shifted by its old size.
+		 * @param[in] other blocks of the other tree
+		 * @param[in] offset offset added to the children, C() stays C()
+		 */
+		void append(const ChildBlocks<C> &other, C offset){
+			uint32_t mediumOffset = (uint32_t)medium.size();
+			uint32_t largeOffset = (uint32_t)large.size();
+			for(const Block16 &block : other.medium){
+				medium.push_back(block);
+				for(C &child : medium.back().children) if(C() != child) child += offset;
+			}
+			for(const Block48 &block : other.large){
+				large.push_back(block);
+				for(C &child : large.back().children) if(C() != child) child += offset;
+			}
+			for(const Block256 &block : other.full){
+				full.push_back(block);
+				for(C &child : full.back().children) if(C() != child) child += offset;
+			}
+			for(uint32_t block : other.freeMedium) freeMedium.push_back(block + mediumOffset);
+			for(uint32_t block : other.freeLarge) freeLarge.push_back(block + largeOffset);
+		}
+};
+
+/** \brief Children of a node, indexed by their tag.
+ * 
+ * C is how a child is referenced, e.g. an index, and C() means no child.
+ * Like the nodes of an Adaptive Radix Tree, the index changes of kind
+ * as children are added, so finding a child stays O(1) :
+ * - up to 4 children : tags and children sorted in arrays inside the index
+ * - up to 16 children : sorted arrays, tags compared at once with SSE2
+ * - up to 48 children : a byte per tag giving the slot of the child
+ * - up to 256 children : a child per tag
+ * The three last kinds keep their children in a block of ChildBlocks,
+ * given to each call, so the index is copied with memcpy.
+ * Children are browsed by increasing tag, as unsigned chars.
+ */
+template <typename C>
+class NodeChildren {
+
+	private:
+		/// number of children each kind of index can hold
+		enum Kind : unsigned short { SMALL = 4, MEDIUM = 16, LARGE = 48, FULL = 256 };
+
+		Kind _kind; /** kind of index, i.e. number of children it can hold */
+		unsigned short _count; /** number of children */
+		unsigned char _tags[SMALL]; /** tags of the children of a SMALL index */
+		union {
+			C _small[SMALL]; /** children of a SMALL index */
+			uint32_t _block; /** block of the children of the other kinds */
+		};
+
+		/** Insert a child into sorted arrays, shifting greater tags
+		 * @param[in] tags sorted tags, with room for one more
+		 * @param[in] children children of the tags
+		 * @param[in] tag tag of the new child
+		 * @param[in] child the new child
+		 */
+		void insertSorted(unsigned char* tags, C* children, unsigned char tag, C child){
+			unsigned i = _count;
+			while(0 < i and tags[i-1] > tag){
+				tags[i] = tags[i-1];
+				children[i] = children[i-1];
+				--i;
+			}
+			tags[i] = tag;
+			children[i] = child;
+		}
+
+		/** Move the children into a block of the next kind
+		 * @param[in] blocks blocks of the tree
+		 */
+		void grow(ChildBlocks<C> &blocks){
+			switch(_kind){
+				case SMALL: {
+					uint32_t block = ChildBlocks<C>::take(blocks.medium, blocks.freeMedium);
+					typename ChildBlocks<C>::Block16 &medium = blocks.medium[block];
+					for(unsigned i = 0; i<_count; ++i){
+						medium.tags[i] = _tags[i];
+						medium.children[i] = _small[i];
+					}
+					_block = block;
+					_kind = MEDIUM;
+					break;
+				}
+				case MEDIUM: {
+					uint32_t block = ChildBlocks<C>::take(blocks.large, blocks.freeLarge);
+					typename ChildBlocks<C>::Block16 &medium = blocks.medium[_block];
+					typename ChildBlocks<C>::Block48 &large = blocks.large[block];
+					for(unsigned t = 0; t<256; ++t) large.slots[t] = 0;
+					for(unsigned i = 0; i<_count; ++i){
+						large.slots[medium.tags[i]] = i+1;
+						large.children[i] = medium.children[i];
+					}
+					blocks.freeMedium.push_back(_block);
+					_block = block;
+					_kind = LARGE;
+					break;
+				}
+				case LARGE: {
+					// nodes never shrink, a block of 256 children is never unused
+					blocks.full.push_back(typename ChildBlocks<C>::Block256());
+					uint32_t block = (uint32_t)(blocks.full.size()-1);
+					typename ChildBlocks<C>::Block48 &large = blocks.large[_block];
+					typename ChildBlocks<C>::Block256 &full = blocks.full[block];
+					for(unsigned t = 0; t<256; ++t){
+						full.children[t] = 0 != large.slots[t] ? large.children[large.slots[t]-1] : C();
+					}
+					blocks.freeLarge.push_back(_block);
+					_block = block;
+					_kind = FULL;
+					break;
+				}
+				case FULL: break;
+			}
+		}
+
+	public:
+		/** Simple constructor, no child
+		 */
+		NodeChildren():
+		_kind(SMALL),
+		_count(0)
+		{
+			for(unsigned i = 0; i<SMALL; ++i){
+				_tags[i] = 0;
+				_small[i] = C();
+			}
+		}
+
+		/** Number of children
+		 * @param[out] count number of children
+		 */
+		unsigned size() const { return _count; }
+
+		/** Child of a tag
+		 * @param[in] tag tag of the child
+		 * @param[in] blocks blocks of the tree
+		 * @param[out] child the child, C() if none
+		 */
+		C find(char tag, const ChildBlocks<C> &blocks) const {
+			unsigned char key = (unsigned char)tag;
+			switch(_kind){
+				case SMALL:
+					for(unsigned i = 0; i<_count; ++i){
+						if(key == _tags[i]) return _small[i];
+					}
+					return C();
+				case MEDIUM: {
+					const typename ChildBlocks<C>::Block16 &medium = blocks.medium[_block];
+#if defined(__SSE2__)
+					__m128i match = _mm_cmpeq_epi8(_mm_set1_epi8((char)key),
+					                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(medium.tags)));
+					unsigned mask = (unsigned)_mm_movemask_epi8(match) & ((1u << _count) - 1);
+					return 0 != mask ? medium.children[__builtin_ctz(mask)] : C();
+#else
+					for(unsigned i = 0; i<_count; ++i){
+						if(key == medium.tags[i]) return medium.children[i];
+					}
+					return C();
+#endif
+				}
+				case LARGE: {
+					const typename ChildBlocks<C>::Block48 &large = blocks.large[_block];
+					return 0 != large.slots[key] ? large.children[large.slots[key]-1] : C();
+				}
+				case FULL:
+					return blocks.full[_block].children[key];
+			}
+			return C();
+		}
+
+		/** Add a child, the tag must not have a child yet
+		 * @param[in] tag tag of the child
+		 * @param[in] child the new child
+		 * @param[in] blocks blocks of the tree
+		 */
+		void insert(char tag, C child, ChildBlocks<C> &blocks){
+			unsigned char key = (unsigned char)tag;
+			if(_count == _kind) grow(blocks);
+			switch(_kind){
+				case SMALL: insertSorted(_tags, _small, key, child); break;
+				case MEDIUM: insertSorted(blocks.medium[_block].tags, blocks.medium[_block].children, key, child); break;
+				case LARGE:
+					blocks.large[_block].children[_count] = child;
+					blocks.large[_block].slots[key] = _count+1;
+					break;
+				case FULL: blocks.full[_block].children[key] = child; break;
+			}
+			++_count;
+		}
+
+		/** Replace the child of a tag, the tag must already have a child
+		 * @param[in] tag tag of the child
+		 * @param[in] child the new child
+		 * @param[in] blocks blocks of the tree
+		 */
+		void replace(char tag, C child, ChildBlocks<C> &blocks){
+			unsigned char key = (unsigned char)tag;
+			switch(_kind){
+				case SMALL:
+					for(unsigned i = 0; i<_count; ++i){
+						if(key == _tags[i]) _small[i] = child;
+					}
+					break;
+				case MEDIUM:
+					for(unsigned i = 0; i<_count; ++i){
+						if(key == blocks.medium[_block].tags[i]) blocks.medium[_block].children[i] = child;
+					}
+					break;
+				case LARGE: blocks.large[_block].children[blocks.large[_block].slots[key]-1] = child; break;
+				case FULL: blocks.full[_block].children[key] = child; break;
+			}
+		}
+
+		/** Follow the children and their block, copied into another tree
+		 * @param[in] offset offset added to the children of a SMALL index
+		 * @param[in] blocks blocks of the other tree, before the copy
+		 */
+		void relocate(C offset, const ChildBlocks<C> &blocks){
+			switch(_kind){
+				case SMALL:
+					for(unsigned i = 0; i<_count; ++i) _small[i] += offset;
+					break;
+				case MEDIUM: _block += (uint32_t)blocks.medium.size(); break;
+				case LARGE: _block += (uint32_t)blocks.large.size(); break;
+				case FULL: _block += (uint32_t)blocks.full.size(); break;
+			}
+		}
+
+		/** Call a function on every child, by increasing tag
+		 * The function must not add children to the tree.
+		 * @param[in] visit function called with each child
+		 * @param[in] blocks blocks of the tree
+		 */
+		template <typename F>
+		void forEach(F visit, const ChildBlocks<C> &blocks) const {
+			switch(_kind){
+				case SMALL:
+					for(unsigned i = 0; i<_count; ++i) visit(_small[i]);
+					break;
+				case MEDIUM:
+					for(unsigned i = 0; i<_count; ++i) visit(blocks.medium[_block].children[i]);
+					break;
+				case LARGE: {
+					const typename ChildBlocks<C>::Block48 &large = blocks.large[_block];
+					for(unsigned t = 0; t<256; ++t){
+						if(0 != large.slots[t]) visit(large.children[large.slots[t]-1]);
+					}
+					break;
+				}
+				case FULL: {
+					const typename ChildBlocks<C>::Block256 &full = blocks.full[_block];
+					for(unsigned t = 0; t<256; ++t){
+						if(C() != full.children[t]) visit(full.children[t]);
+					}
+					break;
+				}
+			}
+		}
+};
+
 /** \brief Defines tree nodes.
  * 
  * Class for nodes of a TreeString.
- * A Node store a letter and can have several children.
+ * A Node store a letter and can have several children. Nodes are stored
+ * by their TreeString and reference their children by their index.
  */
 class Node {
 	
 	private:
-		/// Number of children
-		int _childNbr;
 		/// the end of a word and his frequency
 		/// if _wordFrequency > 0, it's a word end
 		int _wordFrequency;
+		/// greatest frequency of the words ending in the subtree of the Node
+		int _maxFrequency;
 		/// letter stored into Node, the tag
 		char _tag;
-		/// children of the Node
-		forward_list<Node*> _children;
+		/// indexes of the children of the Node, by tag
+		NodeChildren<uint32_t> _children;
 	
 	public:
-		/** Copy constructor
-		 * @param[in] other Node to copy
-		 */
-		Node(const Node &other):
-			_childNbr(other._childNbr),
-			_wordFrequency(other._wordFrequency),
-			_tag(other._tag),
-			_children(other._children)
-			{}
-			
 		/** Simple constructor
 		 * @param[in] data to store into the Node
-		 * @param[in] end is it the last letter of a word ?
+		 * @param[in] frequency if greater than 0, end of a word.
 		 */
 		Node(char data, int frequency):
-		_childNbr(0),
 		_wordFrequency(frequency),
+		_maxFrequency(frequency),
 		_tag(data)
-		{
-			// initialize the simply-linked list
-			_children = forward_list<Node*>();
-		}
+		{}
 		
 		/** Empty constructor
 		 */
 		Node():
-		_childNbr(0),
 		_wordFrequency(0),
+		_maxFrequency(0),
 		_tag('@')
-		{
-			// initialize the simply-linked list
-			_children = forward_list<Node*>();
-		}
-		
-		/** Destructor for Node
-		 */
-		~Node(){
-			// usefull ?
-			//delete &_children;
-			//delete &_tag;
-		}
-		
-		/** assignment operator overload
-		 * @param[in] other node to assign
-		 * @param[out] note assigned node
-		 */
-		Node& operator=(const Node &other){
-			// prevent objet copying itself
-			if(this != &other){
-				this->_childNbr = other._childNbr;
-				this->_tag = other._tag;
-				this->_wordFrequency = other._wordFrequency;
-				this->_children = other._children;
-			}
-			return (*this); // allow a = b = c
-		}
+		{}
 		
 		/** equality operator
 		 * @param[in] lhs left hand side, first node to compare
@@ -176,193 +473,448 @@ class Node {
 		/** Is the node a leaf ?
 		 * @param[out] bool true, if no child, else false
 		 */
-		bool isLeaf(){
-			return 0 == _childNbr;
-			//return frenquency > 0;
-		}
-		
-		/** The height of the node
-		 * @param[out] hgt height of the node
-		 */
-		int height(){
-			if(isLeaf()){
-				return 0;
-			}
-			else {
-				// start heights at zero
-				// heights[0] : greatest height, heights[1] : computed height in the loop
-				int heights[2] = {0,0};
-				// for each child - using C++11 syntax
-				for(Node* child : _children){
-					// compute child height and store it
-					heights[1] = 1 + child->height();
-					// if computed height is greater then the old one
-					if(heights[0] < heights[1]){
-						// store it as the new greate one
-						heights[0] = heights[1];
-					} // else, nothing
-				}
-				return heights[0];
-			}
+		bool isLeaf() const {
+			return 0 == _children.size();
 		}
 		
-		/** Hook up a new child to the node
-		 * @param[in] n_data new data to store as a child of the node
-		 * @param[in] frequency if greater than 0, end of a word.
-		 * @param[out] newchild return the adress of the new child created
-		 */
-		Node* append(const char n_data, int frequency){
-			Node* tmp;
-			bool undone = true;
-			auto it = _children.begin();
-			// while n_data is not added
-			while(undone and it != _children.end()){
-				if(n_data == (*it)->_tag){
-					(*it)->_wordFrequency += frequency; // update word frenquency
-					tmp = (*it);
-					undone = !undone; // job is now done
-				}
-				++it;
-			}
-			// if letter is not present, add it
-			if(undone){
-				 tmp = new Node(n_data, frequency);
-				_children.push_front(tmp);
-				_childNbr++;
-			}
-			return tmp;
-		}  
-		
 		/** What is the tag of the Node ?
 		 * @param[out] tag The tag of the node
 		 */
-		char getTag(){ return _tag; }
-		
-		
-		/** Get a string representation of the node and his child
-		 * @param[out] desc Description of the node (and his child)
+		char getTag() const { return _tag; }
+
+		/** How many times the word ending with this Node was added ?
+		 * @param[out] frequency frequency of the word, 0 if no word ends here
 		 */
-		string toString(){
-			if(isLeaf()){
-				return string(&_tag);
-			}
-			else {
-				string desc = string(&_tag);
-				for(Node* child: _children){
-					desc += ", " + child->toString();
-				}
-				return desc;
-			}
-		}
+		int getFrequency() const { return _wordFrequency; }
 
-		/** Put each words in a list
-		 * @param[in] words List containing all words
-		 * @param[in] string wordCom Word which is currently reconvene
+		/** Count the word ending with this Node again
+		 * @param[in] frequency frequency to add
 		 */
-		void toList(forward_list<string> &words, string word){
-			'@' != _tag?word += _tag:word; // if it's not the root, add tag
-			if(0 < _wordFrequency){
-				words.push_front(word);
-			}
-			if(not isLeaf()){
-				for(Node* child : _children){
-					child->toList(words, word);
-				}
-			}
-		}
+		void addFrequency(int frequency){ _wordFrequency += frequency; }
 
-		/** Put each word in a list
-		 * @param[in] words List containing all words and his frequency in pairs
-		 * @param[in] string wordCom Word which is currently reconvene
-		 */
-		void toFrequencedList(forward_list<pair<string,int>> &words, string word){
-			// if it's not the root, add tag
-			// avoid to prefix words with '@', the root char
-			'@' != _tag?word += _tag:word;
-			// if it's a word end
-			if(0 < _wordFrequency){
-				// add the word and his frequency in a pair and
-				// add it to the list
-				words.push_front(pair<string,int>(word, _wordFrequency));
-			}
-			// if it's not a leaf
-			if(not isLeaf()){
-				// for each child
-				for(Node* child : _children){
-					// get words in the subtree
-					child->toFrequencedList(words, word);
-				}
-			}
+		/** Greatest frequency of the words ending in the subtree of the Node
+		 * @param[out] frequency greatest frequency, 0 if no word ends there
+		 */
+		int getMaxFrequency() const { return _maxFrequency; }
+
+		/** Tell the Node a word of its subtree reached a frequency
+		 * @param[in] frequency frequency of the word
+		 */
+		void raiseMaxFrequency(int frequency){
+			if(_maxFrequency < frequency) _maxFrequency = frequency;
 		}
 
+		/** Children of the Node
+		 * @param[out] children indexes of the children, by tag
+		 */
+		NodeChildren<uint32_t>& children(){ return _children; }
+
+		/** Children of the Node
+		 * @param[out] children indexes of the children, by tag
+		 */
+		const NodeChildren<uint32_t>& children() const { return _children; }
 };
 
 /** \brief Tree is a recursive structure using nodes.
  * 
  * A root value and subtrees of children, represented as a set of linked nodes.
+ * The nodes are stored one after the other in a vector, the root first,
+ * and linked by their 32 bits index : the tree is copied with a few
+ * memcpy and freed at once.
  */
 class TreeString {
 	
 	private:
-		Node _root; /** First node of the tree */
-	
+		vector<Node> _nodes; /** nodes of the tree, the root first */
+		ChildBlocks<uint32_t> _blocks; /** blocks of children of the nodes */
+
+		/// index of the root, never a child so 0 also means no child
+		static constexpr uint32_t ROOT = 0;
+
+		/** Hook up a child to a node, or count it again if present
+		 * @param[in] parent index of the node
+		 * @param[in] tag letter of the child
+		 * @param[in] frequency if greater than 0, end of a word.
+		 * @param[out] child index of the child
+		 */
+		uint32_t append(uint32_t parent, char tag, int frequency){
+			uint32_t child = _nodes[parent].children().find(tag, _blocks);
+			if(ROOT != child){
+				_nodes[child].addFrequency(frequency);
+			}
+			// if letter is not present, add it
+			else {
+				child = (uint32_t)_nodes.size();
+				_nodes.push_back(Node(tag, frequency));
+				_nodes[parent].children().insert(tag, child, _blocks);
+			}
+			return child;
+		}
+
+		/** Add the words below a node of another tree below a node
+		 * Frequencies of the words in both trees are summed.
+		 * @param[in] node index of the node
+		 * @param[in] other the other tree
+		 * @param[in] otherNode index of the node of the other tree
+		 * @param[out] max greatest frequency below the node afterwards
+		 */
+		int merge(uint32_t node, const TreeString &other, uint32_t otherNode){
+			_nodes[node].addFrequency(other._nodes[otherNode].getFrequency());
+			// frequencies only grow, the children left alone keep their maximum
+			int max = _nodes[node].getFrequency();
+			other._nodes[otherNode].children().forEach([this, &other, node, &max](uint32_t otherChild){
+				uint32_t child = append(node, other._nodes[otherChild].getTag(), 0);
+				int childMax = merge(child, other, otherChild);
+				if(max < childMax) max = childMax;
+			}, other._blocks);
+			_nodes[node].raiseMaxFrequency(max);
+			return _nodes[node].getMaxFrequency();
+		}
+
+		/** Add the words of another tree whose first letter belongs to a part
+		 * First letters are shared between parts by their code, so trees
+		 * merged into different parts have no first letter in common.
+		 * @param[in] other the other tree
+		 * @param[in] part the part
+		 * @param[in] parts number of parts
+		 */
+		void merge(const TreeString &other, unsigned part, unsigned parts){
+			other._nodes[ROOT].children().forEach([this, &other, part, parts](uint32_t otherChild){
+				char tag = other._nodes[otherChild].getTag();
+				if(part != (unsigned char)tag % parts) return;
+				uint32_t child = append(ROOT, tag, 0);
+				int max = merge(child, other, otherChild);
+				_nodes[ROOT].raiseMaxFrequency(max);
+			}, other._blocks);
+		}
+
+		/** Copy the nodes of another tree after the nodes of this one
+		 * The trees must have no first letter in common : nodes and blocks
+		 * are copied side by side, and their indexes shifted, without any search.
+		 * @param[in] other the other tree
+		 */
+		void graft(const TreeString &other){
+			// node i of the other tree, but its root, becomes node i + offset
+			uint32_t offset = (uint32_t)(_nodes.size()-1);
+			size_t first = _nodes.size();
+			_nodes.insert(_nodes.end(), other._nodes.begin()+1, other._nodes.end());
+			for(size_t i = first; i<_nodes.size(); ++i){
+				_nodes[i].children().relocate(offset, _blocks);
+			}
+			_blocks.append(other._blocks, offset);
+			other._nodes[ROOT].children().forEach([this, &other, offset](uint32_t child){
+				assert(ROOT == _nodes[ROOT].children().find(other._nodes[child].getTag(), _blocks));
+				_nodes[ROOT].children().insert(other._nodes[child].getTag(), child + offset, _blocks);
+			}, other._blocks);
+			_nodes[ROOT].raiseMaxFrequency(other._nodes[ROOT].getMaxFrequency());
+		}
+
+		/** The height of a node
+		 * @param[in] node index of the node
+		 * @param[out] hgt height of the node
+		 */
+		int height(uint32_t node) const {
+			int hgt = 0;
+			_nodes[node].children().forEach([this, &hgt](uint32_t child){
+				int childHeight = 1 + height(child);
+				if(hgt < childHeight) hgt = childHeight;
+			}, _blocks);
+			return hgt;
+		}
+
+		/** Get a string representation of a node and its children
+		 * @param[in] node index of the node
+		 * @param[out] desc Description of the node (and his child)
+		 */
+		string toString(uint32_t node) const {
+			string desc = string(1, _nodes[node].getTag());
+			_nodes[node].children().forEach([this, &desc](uint32_t child){
+				desc += ", " + toString(child);
+			}, _blocks);
+			return desc;
+		}
+
 	public:
 		/** Default constructor
 		 */
 		TreeString():
-			_root(Node())
+			_nodes(1, Node())
 			{}
-			
-		/** Copy constructor
-		 */
-		TreeString(const TreeString &other):
-			_root(other._root)
-			{}
-		
-		/** Destructor, destroy the whole tree
-		 */
-		~TreeString(){
-			//delete &_root;
-		}
 		
 		/** The height of the tree
 		 * @param[out] hgt Height of the tree
 		 */
-		int height(){
-			return _root.height();
+		int height() const {
+			return height(ROOT);
+		}
+
+		/** Number of nodes of the tree, the root included
+		 * @param[out] count number of nodes
+		 */
+		size_t nodeCount() const {
+			return _nodes.size();
 		}
 		
 		/** Put a word in the tree
 		 * @param[in] word New element to put into the tree
+		 * @param[out] frequency frequency of the word afterwards, 1 if it is new
 		 */
-		void put(const string &word){
-			// adress of the last added Node
-			Node* lastInserted = &_root;
-			int i;
-			int i_end = word.size()-1;
+		int put(string_view word){
+			// an empty word has no last letter to count it
+			if(word.empty()) return 0;
+			// index of the last added Node
+			uint32_t lastInserted = ROOT;
+			// nodes of the first letters of the word, and of the root
+			uint32_t path[TREEPATH];
+			path[0] = ROOT;
+			size_t i;
+			size_t i_end = word.size()-1;
 			// from the first to the last-but-one char
 			for(i=0; i<i_end; ++i){
 				// add it to the tree
-				lastInserted = lastInserted->append(word[i], 0);
+				lastInserted = append(lastInserted, word[i], 0);
+				if(i+1 < TREEPATH) path[i+1] = lastInserted;
 			}
 			// add the last char and the frequence of the word
-			lastInserted->append(word[i], 1); // end of the word
+			lastInserted = append(lastInserted, word[i], 1); // end of the word
+			// the word may now be the most frequent of the subtrees holding it,
+			// a node is never less frequent than its children so the nodes
+			// are raised from the word up to the first one already frequent enough
+			int frequency = _nodes[lastInserted].getFrequency();
+			_nodes[lastInserted].raiseMaxFrequency(frequency);
+			if(TREEPATH <= word.size()){
+				// the path is too long to be remembered, walk it again
+				uint32_t node = ROOT;
+				_nodes[node].raiseMaxFrequency(frequency);
+				for(i=0; i<i_end; ++i){
+					node = _nodes[node].children().find(word[i], _blocks);
+					_nodes[node].raiseMaxFrequency(frequency);
+				}
+				return frequency;
+			}
+			for(i=word.size(); 0 < i and _nodes[path[i-1]].getMaxFrequency() < frequency; --i){
+				_nodes[path[i-1]].raiseMaxFrequency(frequency);
+			}
+			return frequency;
+		}
+
+		/** Put several words in the tree, with several threads
+		 * Each thread builds a tree from a slice of the words, then each
+		 * thread merges the words of every tree starting with its own first
+		 * letters : the trees of the threads are then copied side by side.
+		 * @param[in] words the words to put
+		 * @param[in] nbThreads number of threads to use
+		 */
+		void putAll(const vector<string> &words, unsigned nbThreads){
+			if(2 > nbThreads or words.size() < nbThreads){
+				for(const string &word : words) put(word);
+				return;
+			}
+			vector<std::thread> threads;
+			vector<TreeString> slices(nbThreads);
+			size_t part = (words.size() + nbThreads - 1)/nbThreads;
+			for(unsigned t = 0; t<nbThreads; ++t){
+				// each thread puts a contiguous slice of the words
+				size_t begin = t*part < words.size() ? t*part : words.size();
+				size_t end = begin + part < words.size() ? begin + part : words.size();
+				threads.emplace_back([&slices, &words, t, begin, end](){
+					for(size_t i = begin; i<end; ++i) slices[t].put(words[i]);
+				});
+			}
+			for(std::thread &thread : threads){
+				thread.join();
+			}
+			threads.clear();
+			// the words already in the tree are merged like the slices
+			vector<TreeString> parts(nbThreads);
+			for(unsigned t = 0; t<nbThreads; ++t){
+				threads.emplace_back([this, &slices, &parts, t, nbThreads](){
+					parts[t].merge(*this, t, nbThreads);
+					for(const TreeString &slice : slices) parts[t].merge(slice, t, nbThreads);
+				});
+			}
+			for(std::thread &thread : threads){
+				thread.join();
+			}
+			vector<TreeString>().swap(slices);
+			*this = TreeString();
+			for(const TreeString &tree : parts) graft(tree);
+		}
+
+		/** Add the words of another tree, summing their frequencies
+		 * @param[in] other the other tree
+		 */
+		void merge(const TreeString &other){
+			if(this == &other){
+				TreeString copy(other);
+				merge(ROOT, copy, ROOT);
+				return;
+			}
+			merge(ROOT, other, ROOT);
+		}
+
+		/** Is a word in the tree ?
+		 * @param[in] word the word to look for
+		 * @param[out] bool true if the word was put, else false
+		 */
+		bool contains(string_view word) const {
+			return 0 < frequency(word);
+		}
+
+		/** How many times a word was put in the tree
+		 * Only the nodes along the word are visited.
+		 * @param[in] word the word to look for
+		 * @param[out] frequency number of times the word was put, 0 if absent
+		 */
+		int frequency(string_view word) const {
+			if(word.empty()) return 0;
+			uint32_t current = ROOT;
+			for(char letter : word){
+				current = _nodes[current].children().find(letter, _blocks);
+				if(ROOT == current) return 0;
+			}
+			return _nodes[current].getFrequency();
+		}
+
+		/** The most frequent words starting with a prefix
+		 * Subtrees are browsed by decreasing greatest frequency, and no more
+		 * once k words more frequent than them are found : only the nodes
+		 * leading to the k words and their children are visited.
+		 * Words of the same frequency come in any order.
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[in] k number of words wanted
+		 * @param[out] words at most k pairs word, frequency, the most frequent first
+		 */
+		vector<pair<string,int>> complete(string_view prefix, size_t k) const {
+			vector<pair<string,int>> words;
+			uint32_t start = ROOT;
+			for(char letter : prefix){
+				start = _nodes[start].children().find(letter, _blocks);
+				if(ROOT == start) return words;
+			}
+			// nodes reached, each with the index of the one it was reached from
+			vector<pair<uint32_t,uint32_t>> reached(1, pair<uint32_t,uint32_t>(start, 0));
+			// greatest frequency, then 1 for a word or 0 for a subtree, then index in reached
+			typedef std::tuple<int,int,uint32_t> Candidate;
+			std::priority_queue<Candidate> candidates;
+			candidates.push(Candidate(_nodes[start].getMaxFrequency(), 0, 0));
+			while(words.size() < k and not candidates.empty()){
+				Candidate best = candidates.top();
+				candidates.pop();
+				uint32_t index = std::get<2>(best);
+				uint32_t node = reached[index].first;
+				// a word comes before the subtrees of its frequency
+				if(1 == std::get<1>(best)){
+					string word;
+					for(uint32_t i = index; 0 != i; i = reached[i].second){
+						word += _nodes[reached[i].first].getTag();
+					}
+					std::reverse(word.begin(), word.end());
+					words.push_back(pair<string,int>(string(prefix) + word, std::get<0>(best)));
+					continue;
+				}
+				if(0 < _nodes[node].getFrequency()){
+					candidates.push(Candidate(_nodes[node].getFrequency(), 1, index));
+				}
+				_nodes[node].children().forEach([this, &reached, &candidates, index](uint32_t child){
+					reached.push_back(pair<uint32_t,uint32_t>(child, index));
+					candidates.push(Candidate(_nodes[child].getMaxFrequency(), 0, (uint32_t)(reached.size()-1)));
+				}, _blocks);
+			}
+			return words;
+		}
+
+		/** The words nearest to a word, e.g. to correct a misspelled word
+		 * The tree is walked carrying a row of Levenshtein distances between
+		 * the prefixes of the word and the letters above the node, one row
+		 * per depth, and a subtree is left as soon as every distance of its
+		 * row exceeds the bound : only the nodes near the word are visited.
+		 * Once k words are found, the bound falls to the distance of the
+		 * worst one, and subtrees less frequent than it are left too.
+		 * @param[in] word the word to look for
+		 * @param[in] maxDistance greatest number of letters inserted, removed or changed
+		 * @param[in] k number of words wanted
+		 * @param[out] words at most k pairs word, frequency, the nearest first,
+		 * then the most frequent, then by increasing letters
+		 */
+		vector<pair<string,int>> fuzzy(string_view word, unsigned maxDistance, size_t k) const {
+			vector<pair<string,int>> words;
+			if(0 == k) return words;
+			size_t width = word.size()+1;
+			// distances of the rows, the row of depth d from width*d
+			vector<unsigned> rows(width);
+			for(size_t j = 0; j<width; ++j) rows[j] = (unsigned)j;
+			// distance, opposite of the frequency, then the word : the worst on top
+			typedef std::tuple<unsigned,int,string> Candidate;
+			std::priority_queue<Candidate> best;
+			unsigned bound = maxDistance;
+			string letters;
+			// nodes to visit, with the length of the word before their tag
+			vector<pair<uint32_t,size_t>> stack;
+			auto pushChildren = [this, &stack, &letters](uint32_t node){
+				size_t first = stack.size();
+				_nodes[node].children().forEach([&stack, &letters](uint32_t child){
+					stack.push_back(pair<uint32_t,size_t>(child, letters.size()));
+				}, _blocks);
+				// children come by increasing tag, the least one must be on top
+				std::reverse(stack.begin() + first, stack.end());
+			};
+			pushChildren(ROOT);
+			while(not stack.empty()){
+				pair<uint32_t,size_t> top = stack.back();
+				stack.pop_back();
+				const Node &node = _nodes[top.first];
+				letters.resize(top.second);
+				letters += node.getTag();
+				size_t depth = letters.size();
+				if(rows.size() < width*(depth+1)) rows.resize(width*(depth+1));
+				// the row above is the one of the parent, the last node visited at its depth
+				const unsigned* above = rows.data() + width*(depth-1);
+				unsigned* row = rows.data() + width*depth;
+				row[0] = (unsigned)depth;
+				unsigned least = row[0];
+				for(size_t j = 1; j<width; ++j){
+					unsigned change = above[j-1] + (word[j-1] == node.getTag() ? 0 : 1);
+					unsigned insert = row[j-1] + 1;
+					unsigned remove = above[j] + 1;
+					row[j] = std::min(change, std::min(insert, remove));
+					if(row[j] < least) least = row[j];
+				}
+				if(0 < node.getFrequency() and row[width-1] <= bound){
+					best.push(Candidate(row[width-1], -node.getFrequency(), letters));
+					if(k < best.size()) best.pop();
+					if(k == best.size() and std::get<0>(best.top()) < bound) bound = std::get<0>(best.top());
+				}
+				if(bound < least) continue;
+				// no word below could be nearer, nor as near and more frequent
+				if(k == best.size() and least == std::get<0>(best.top())
+				   and node.getMaxFrequency() <= -std::get<1>(best.top())) continue;
+				pushChildren(top.first);
+			}
+			words.resize(best.size());
+			for(size_t i = best.size(); 0 < i; --i){
+				words[i-1] = pair<string,int>(std::get<2>(best.top()), -std::get<1>(best.top()));
+				best.pop();
+			}
+			return words;
 		}
 
 		/** Get a string representation of the Tree
 		 * @param[out] desc A string reprensation of the Tree where
 		 * each Node tag is separated by a comma
 		 */
-		string toString(){
-			return _root.toString();
+		string toString() const {
+			return toString(ROOT);
 		}
 
 		/** Put each word in a list
 		 * The list must be initialized !
 		 * @param[in] list List containing string for each word stored in Tree
 		 */
-		void getWords(forward_list<string> &list){
-			_root.toList(list, string());
+		void getWords(forward_list<string> &list) const {
+			forEachWord([&list](string_view word, int){
+				list.push_front(string(word));
+			});
 		}
 		
 		/** Get a list of all words stored in Tree and
@@ -370,10 +922,78 @@ class TreeString {
 		 * @param[int] list List of pair containing for each word in Tree
 		 * his frequency
 		 */
-		void getWordsFrequencies(forward_list<pair<string,int>> &words){
+		void getWordsFrequencies(forward_list<pair<string,int>> &words) const {
 			// get the list of all words stored
-			_root.toFrequencedList(words, string());
+			forEachWord([&words](string_view word, int frequency){
+				words.push_front(pair<string,int>(string(word), frequency));
+			});
+		}
+
+		/** Call a function on every word starting with a prefix, in
+		 * increasing order of their letters as unsigned chars
+		 * The tree is walked with a stack of nodes and a single buffer
+		 * holding the current word, nothing is allocated for each word.
+		 * @param[in] prefix the prefix, empty for every word
+		 * @param[in] visit function called with each word, as a string_view
+		 * valid during the call only, and its frequency
+		 */
+		template <typename F>
+		void forEachWord(string_view prefix, F visit) const {
+			uint32_t start = ROOT;
+			for(char letter : prefix){
+				start = _nodes[start].children().find(letter, _blocks);
+				if(ROOT == start) return;
+			}
+			string word(prefix);
+			if(0 < _nodes[start].getFrequency()) visit(string_view(word), _nodes[start].getFrequency());
+			// nodes to visit, with the length of the word before their tag
+			vector<pair<uint32_t,size_t>> stack;
+			auto pushChildren = [this, &stack, &word](uint32_t node){
+				size_t first = stack.size();
+				_nodes[node].children().forEach([&stack, &word](uint32_t child){
+					stack.push_back(pair<uint32_t,size_t>(child, word.size()));
+				}, _blocks);
+				// children come by increasing tag, the least one must be on top
+				std::reverse(stack.begin() + first, stack.end());
+			};
+			pushChildren(start);
+			while(not stack.empty()){
+				pair<uint32_t,size_t> top = stack.back();
+				stack.pop_back();
+				word.resize(top.second);
+				word += _nodes[top.first].getTag();
+				if(0 < _nodes[top.first].getFrequency()) visit(string_view(word), _nodes[top.first].getFrequency());
+				pushChildren(top.first);
+			}
+		}
+
+		/** Call a function on every word, in increasing order
+		 * @param[in] visit function called with each word, as a string_view
+		 * valid during the call only, and its frequency
+		 */
+		template <typename F>
+		void forEachWord(F visit) const {
+			forEachWord(string_view(), visit);
 		}
 };
 
+/** \brief Can a tree put several words with several threads (putAll) ?
+ * value is true for TreeString, false for the other trees.
+ */
+template <typename T>
+struct ParallelPut : std::false_type {};
+
+/** \brief TreeString builds a tree per thread then merges them
+ */
+template <>
+struct ParallelPut<TreeString> : std::true_type {};
+
+/**
+ * Enable the constructors taking a tree of words, i.e. any type with
+ * forEachWord. Other arguments, e.g. the path of a file given as a string
+ * literal, use the other constructors.
+*/
+template <typename T>
+using EnableTree = decltype(std::declval<const T&>().forEachWord(std::declval<void(*)(string_view,int)>()));
+
 #endif // TREESTRING_HPP